@@ -0,0 +1,701 @@
+# 0 "build/host/inc/ds1302.c"
+# 0 "<built-in>"
+# 0 "<command-line>"
+# 1 "/usr/include/stdc-predef.h" 1 3 4
+# 0 "<command-line>" 2
+# 1 "build/host/inc/ds1302.c"
+
+
+
+
+
+
+# 1 "build/host/inc/ds1302.h" 1
+
+
+
+
+# 1 "build/host/inc/stc15.h" 1
+
+
+
+# 1 "build/host/inc/8051.h" 1
+# 1 "test/mcs51.h" 1
+
+
+
+
+
+
+
+# 1 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 1 3 4
+# 9 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 3 4
+# 1 "/usr/include/stdint.h" 1 3 4
+# 26 "/usr/include/stdint.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 1 3 4
+# 33 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 3 4
+# 1 "/usr/include/features.h" 1 3 4
+# 392 "/usr/include/features.h" 3 4
+# 1 "/usr/include/features-time64.h" 1 3 4
+# 20 "/usr/include/features-time64.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 21 "/usr/include/features-time64.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 22 "/usr/include/features-time64.h" 2 3 4
+# 393 "/usr/include/features.h" 2 3 4
+# 489 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 1 3 4
+# 561 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 562 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/long-double.h" 1 3 4
+# 563 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 490 "/usr/include/features.h" 2 3 4
+# 513 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 1 3 4
+# 10 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs-64.h" 1 3 4
+# 11 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 2 3 4
+# 514 "/usr/include/features.h" 2 3 4
+# 34 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 2 3 4
+# 27 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/types.h" 1 3 4
+# 27 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 28 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 29 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+
+# 31 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+typedef unsigned char __u_char;
+typedef unsigned short int __u_short;
+typedef unsigned int __u_int;
+typedef unsigned long int __u_long;
+
+
+typedef signed char __int8_t;
+typedef unsigned char __uint8_t;
+typedef signed short int __int16_t;
+typedef unsigned short int __uint16_t;
+typedef signed int __int32_t;
+typedef unsigned int __uint32_t;
+
+typedef signed long int __int64_t;
+typedef unsigned long int __uint64_t;
+
+
+
+
+
+
+typedef __int8_t __int_least8_t;
+typedef __uint8_t __uint_least8_t;
+typedef __int16_t __int_least16_t;
+typedef __uint16_t __uint_least16_t;
+typedef __int32_t __int_least32_t;
+typedef __uint32_t __uint_least32_t;
+typedef __int64_t __int_least64_t;
+typedef __uint64_t __uint_least64_t;
+
+
+
+typedef long int __quad_t;
+typedef unsigned long int __u_quad_t;
+
+
+
+
+
+
+
+typedef long int __intmax_t;
+typedef unsigned long int __uintmax_t;
+# 141 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/typesizes.h" 1 3 4
+# 142 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/time64.h" 1 3 4
+# 143 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+typedef unsigned long int __dev_t;
+typedef unsigned int __uid_t;
+typedef unsigned int __gid_t;
+typedef unsigned long int __ino_t;
+typedef unsigned long int __ino64_t;
+typedef unsigned int __mode_t;
+typedef unsigned long int __nlink_t;
+typedef long int __off_t;
+typedef long int __off64_t;
+typedef int __pid_t;
+typedef struct { int __val[2]; } __fsid_t;
+typedef long int __clock_t;
+typedef unsigned long int __rlim_t;
+typedef unsigned long int __rlim64_t;
+typedef unsigned int __id_t;
+typedef long int __time_t;
+typedef unsigned int __useconds_t;
+typedef long int __suseconds_t;
+typedef long int __suseconds64_t;
+
+typedef int __daddr_t;
+typedef int __key_t;
+
+
+typedef int __clockid_t;
+
+
+typedef void * __timer_t;
+
+
+typedef long int __blksize_t;
+
+
+
+
+typedef long int __blkcnt_t;
+typedef long int __blkcnt64_t;
+
+
+typedef unsigned long int __fsblkcnt_t;
+typedef unsigned long int __fsblkcnt64_t;
+
+
+typedef unsigned long int __fsfilcnt_t;
+typedef unsigned long int __fsfilcnt64_t;
+
+
+typedef long int __fsword_t;
+
+typedef long int __ssize_t;
+
+
+typedef long int __syscall_slong_t;
+
+typedef unsigned long int __syscall_ulong_t;
+
+
+
+typedef __off64_t __loff_t;
+typedef char *__caddr_t;
+
+
+typedef long int __intptr_t;
+
+
+typedef unsigned int __socklen_t;
+
+
+
+
+typedef int __sig_atomic_t;
+# 28 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wchar.h" 1 3 4
+# 29 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 30 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 3 4
+typedef __int8_t int8_t;
+typedef __int16_t int16_t;
+typedef __int32_t int32_t;
+typedef __int64_t int64_t;
+# 35 "/usr/include/stdint.h" 2 3 4
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 3 4
+typedef __uint8_t uint8_t;
+typedef __uint16_t uint16_t;
+typedef __uint32_t uint32_t;
+typedef __uint64_t uint64_t;
+# 38 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+
+typedef __int_least8_t int_least8_t;
+typedef __int_least16_t int_least16_t;
+typedef __int_least32_t int_least32_t;
+typedef __int_least64_t int_least64_t;
+
+
+typedef __uint_least8_t uint_least8_t;
+typedef __uint_least16_t uint_least16_t;
+typedef __uint_least32_t uint_least32_t;
+typedef __uint_least64_t uint_least64_t;
+
+
+
+
+
+typedef signed char int_fast8_t;
+
+typedef long int int_fast16_t;
+typedef long int int_fast32_t;
+typedef long int int_fast64_t;
+# 71 "/usr/include/stdint.h" 3 4
+typedef unsigned char uint_fast8_t;
+
+typedef unsigned long int uint_fast16_t;
+typedef unsigned long int uint_fast32_t;
+typedef unsigned long int uint_fast64_t;
+# 87 "/usr/include/stdint.h" 3 4
+typedef long int intptr_t;
+
+
+typedef unsigned long int uintptr_t;
+# 101 "/usr/include/stdint.h" 3 4
+typedef __intmax_t intmax_t;
+typedef __uintmax_t uintmax_t;
+# 10 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 2 3 4
+# 9 "test/mcs51.h" 2
+
+
+
+# 11 "test/mcs51.h"
+extern volatile uint8_t mcs51_iram[256];
+extern volatile uint8_t mcs51_sfr[256];
+
+
+
+uint8_t mcs51_bit(uint8_t addr);
+void mcs51_setbit(uint8_t addr, uint8_t v);
+
+
+
+
+
+
+
+extern void (*mcs51_pin_write)(uint8_t addr, uint8_t v);
+extern uint8_t (*mcs51_pin_read)(uint8_t addr, uint8_t latch);
+
+
+
+
+
+
+
+void mcs51_asm(const char *text);
+extern unsigned long mcs51_clocks;
+# 2 "build/host/inc/8051.h" 2
+# 5 "build/host/inc/stc15.h" 2
+# 6 "build/host/inc/ds1302.h" 2
+# 171 "build/host/inc/ds1302.h"
+void ds_ram_config_init();
+void ds_ram_config_write();
+
+
+
+void ds_ram_writeburst( uint8_t *buf, uint8_t len);
+
+
+
+uint8_t ds_ram_readburst( uint8_t *buf, uint8_t len);
+
+
+uint8_t ds_readbyte(uint8_t addr);
+
+
+void ds_readburst();
+
+
+void ds_writebyte(uint8_t addr, uint8_t data);
+
+
+void ds_init();
+
+
+void ds_reset_clock();
+
+
+void ds_hours_12_24_toggle();
+
+
+void ds_hours_incr();
+
+
+void ds_minutes_incr();
+
+
+void ds_month_incr();
+
+
+void ds_day_incr();
+
+void ds_weekday_incr();
+void ds_sec_zero();
+
+
+uint8_t ds_hour24();
+
+
+uint8_t ds_split2int(uint8_t tens_ones);
+
+
+uint8_t ds_int2bcd(uint8_t integer);
+
+
+uint8_t ds_int2bcd_tens(uint8_t integer);
+uint8_t ds_int2bcd_ones(uint8_t integer);
+# 8 "build/host/inc/ds1302.c" 2
+# 16 "build/host/inc/ds1302.c"
+uint8_t readbyte();
+void sendbyte(uint8_t b);
+# 28 "build/host/inc/ds1302.c"
+void ds_ram_config_init() {
+    uint8_t buf[6], i;
+
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+    sendbyte(1 << 7 | 1 << 6 | 31 << 1 | 1);
+    for (i=0; i!=6; i++)
+        buf[i] = readbyte();
+    mcs51_setbit(0x90, 0);
+    ;
+
+
+
+    if (buf[0] != 0xA5 || (buf[1] != 0x5A && buf[1] != 0x5B)) {
+
+        ds_ram_writeburst(0, 0);
+        return;
+    }
+
+
+    for (i=0; i!=4; i++)
+        (*(uint8_t (*)[4])(mcs51_iram + 0x2c))[i] = buf[i + 2];
+}
+
+void ds_ram_config_write() {
+    uint8_t i,j;
+    j=1 << 6>>1|2;
+    for (i=0; i!=4; i++)
+        ds_writebyte( j++, (*(uint8_t (*)[4])(mcs51_iram + 0x2c))[i]);
+}
+
+void ds_ram_writeburst( uint8_t *buf, uint8_t len) {
+
+
+    uint8_t i;
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+    sendbyte(1 << 7 | 1 << 6 | 31 << 1 | 0);
+    sendbyte(0xA5);
+    sendbyte(0x5B);
+    for (i=0; i!=4; i++)
+        sendbyte((*(uint8_t (*)[4])(mcs51_iram + 0x2c))[i]);
+    for (i=6; i!=31; i++) {
+        if (len) {
+            sendbyte(*buf++);
+            len--;
+        } else {
+            sendbyte(0xFF);
+        }
+    }
+    mcs51_setbit(0x90, 0);
+    ;
+}
+
+uint8_t ds_ram_readburst( uint8_t *buf, uint8_t len) {
+
+    uint8_t i, ok;
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+    sendbyte(1 << 7 | 1 << 6 | 31 << 1 | 1);
+    ok = readbyte() == 0xA5;
+    if (readbyte() != 0x5B) ok = 0;
+    for (i=0; i!=4; i++)
+        readbyte();
+    while (len--)
+        *buf++ = readbyte();
+    mcs51_setbit(0x90, 0);
+    ;
+    return ok;
+}
+
+void sendbyte(uint8_t b)
+{ mcs51_sfr[0x82] = b;
+  b;
+  mcs51_asm(
+"push ar7" "\n"
+"mov a,dpl" "\n"
+"mov r7,#8" "\n"
+"00001$:" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"rrc a" "\n"
+"mov (0x91),c" "\n"
+"setb (0x92)" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"clr (0x92)" "\n"
+"djnz r7,00001$" "\n"
+"pop ar7" "\n"
+);
+}
+
+uint8_t readbyte()
+{
+  mcs51_asm(
+"push ar7" "\n"
+"mov a,#0" "\n"
+"mov r7,#8" "\n"
+"00002$:" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"mov c,(0x91)" "\n"
+"rrc a" "\n"
+"setb (0x92)" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"clr (0x92)" "\n"
+"djnz r7,00002$" "\n"
+"mov dpl,a" "\n"
+"pop ar7" "\n"
+);
+ return mcs51_sfr[0x82];
+}
+
+uint8_t ds_readbyte(uint8_t addr) {
+
+    uint8_t b;
+    b = 1 << 7 | 0 << 6 | addr << 1 | 1;
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+
+    sendbyte(b);
+
+    b=readbyte();
+    mcs51_setbit(0x90, 0);
+    ;
+    return b;
+}
+
+void ds_readburst() {
+
+    uint8_t b;
+    b = 1 << 7 | 0 << 6 | 31 << 1 | 1;
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+
+    sendbyte(b);
+
+
+  mcs51_asm(
+"mov r0,#0x24" "\n"
+"mov r6,#8" "\n"
+"00003$:" "\n"
+"mov r7,#8" "\n"
+"00004$:" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"mov c,(0x91)" "\n"
+"rrc a" "\n"
+"setb (0x92)" "\n"
+
+"nop" "\n"
+"nop" "\n"
+
+"clr (0x92)" "\n"
+"djnz r7,00004$" "\n"
+"mov @r0,a" "\n"
+"inc r0" "\n"
+"djnz r6,00003$" "\n"
+);
+    mcs51_setbit(0x90, 0);
+    ;
+}
+
+void ds_writebyte(uint8_t addr, uint8_t data) {
+
+    uint8_t b = 0;
+    b = 1 << 7 | 0 << 6 | addr << 1 | 0;
+    ;
+    mcs51_setbit(0x90, 0);
+    mcs51_setbit(0x92, 0);
+    mcs51_setbit(0x90, 1);
+
+    sendbyte(b);
+
+    sendbyte(data);
+
+    mcs51_setbit(0x90, 0);
+    ;
+}
+
+void ds_init() {
+
+
+    ds_readburst();
+    if ((*(uint8_t (*)[8])(mcs51_iram + 0x24))[7])
+        ds_writebyte(7, 0);
+    if ((*(uint8_t (*)[8])(mcs51_iram + 0x24))[0] & 0b10000000) {
+        (*(uint8_t (*)[8])(mcs51_iram + 0x24))[0] &= ~(0b10000000);
+        ds_writebyte(0, (*(uint8_t (*)[8])(mcs51_iram + 0x24))[0]);
+    }
+}
+
+
+void ds_reset_clock() {
+    ds_writebyte(1, 0x00);
+    ds_writebyte(2, 0b10000000|0x07);
+    ds_writebyte(4, 0x01);
+    ds_writebyte(3, 0x01);
+}
+
+void ds_hours_12_24_toggle() {
+
+    uint8_t hours,b;
+    if (mcs51_bit(0x37))
+    {
+      hours=ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2]&0b00011111);
+      if (hours==12)
+       {if (!mcs51_bit(0x35)) hours=0;}
+      else
+       {if (mcs51_bit(0x35)) hours+=12;}
+      b = ds_int2bcd(hours);
+    }
+    else
+    {
+      hours = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2]&0b00111111);
+      b = 0b10000000;
+      if (hours >= 12) { hours-=12; b|=0x20; }
+      if (hours == 0) { hours=12; }
+      b |= ds_int2bcd(hours);
+    }
+
+    ds_writebyte(2,b);
+}
+
+
+void ds_hours_incr() {
+    uint8_t hours, b = 0;
+    if (!mcs51_bit(0x37)) {
+        hours = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2]&0b00111111);
+        if (hours < 23)
+            hours++;
+        else {
+            hours = 00;
+        }
+        b = ds_int2bcd(hours);
+    } else {
+        hours = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2]&0b00011111);
+        if (hours < 12)
+            hours++;
+        else
+            hours = 1;
+        if (hours == 12)
+            mcs51_setbit(0x35, !mcs51_bit(0x35));
+        b = (mcs51_bit(0x35)?(0b10000000|0b00100000):0b10000000) | ds_int2bcd(hours);
+    }
+
+    ds_writebyte(2, b);
+}
+
+
+void ds_minutes_incr() {
+    uint8_t minutes = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[1]&0b01111111);
+    if (minutes < 59)
+        minutes++;
+    else
+        minutes = 1;
+    ds_writebyte(1, ds_int2bcd(minutes));
+}
+
+
+void ds_month_incr() {
+    uint8_t month = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[4]&0b00011111);
+    if (month < 12)
+        month++;
+    else
+        month = 1;
+    ds_writebyte(4, ds_int2bcd(month));
+}
+
+
+void ds_day_incr() {
+    uint8_t day = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[3]&0b00111111);
+    if (day < 31)
+        day++;
+    else
+        day = 1;
+    ds_writebyte(3, ds_int2bcd(day));
+}
+
+void ds_weekday_incr() {
+    uint8_t day = (*(uint8_t (*)[8])(mcs51_iram + 0x24))[5];
+    if (day < 7)
+        day++;
+    else
+        day=1;
+    ds_writebyte(5, day);
+    (*(uint8_t (*)[8])(mcs51_iram + 0x24))[5] = day;
+}
+
+void ds_sec_zero() {
+    (*(uint8_t (*)[8])(mcs51_iram + 0x24))[0]=0;
+    ds_writebyte(0,0);
+}
+
+
+uint8_t ds_hour24() {
+    uint8_t hours;
+    if (mcs51_bit(0x37)) {
+        hours = ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2] & 0b00011111);
+        if (hours == 12) hours = 0;
+        if (mcs51_bit(0x35)) hours += 12;
+        return hours;
+    }
+    return ds_split2int((*(uint8_t (*)[8])(mcs51_iram + 0x24))[2] & 0b00111111);
+}
+
+uint8_t ds_split2int(uint8_t tens_ones) {
+    return (tens_ones>>4) * 10 + (tens_ones&0xF);
+}
+
+
+uint8_t ds_int2bcd(uint8_t integer) {
+    return integer / 10 << 4 | integer % 10;
+}
+
+uint8_t ds_int2bcd_tens(uint8_t integer) {
+    return integer / 10 % 10;
+}
+
+uint8_t ds_int2bcd_ones(uint8_t integer) {
+    return integer % 10;
+}
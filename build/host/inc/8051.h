@@ -0,0 +1,191 @@
+#include "mcs51.h"
+// 8051 core registers for the host build, the subset of sdcc's <8051.h>
+// the sources use, same sdcc syntax (converted by hostconv.py)
+//
+
+#ifndef REG8051_H
+#define REG8051_H
+
+#define P0 mcs51_sfr[0x80]
+#define _P0 0x80
+#define SP mcs51_sfr[0x81]
+#define _SP 0x81
+#define DPL mcs51_sfr[0x82]
+#define _DPL 0x82
+#define DPH mcs51_sfr[0x83]
+#define _DPH 0x83
+#define PCON mcs51_sfr[0x87]
+#define _PCON 0x87
+#define TCON mcs51_sfr[0x88]
+#define _TCON 0x88
+#define TMOD mcs51_sfr[0x89]
+#define _TMOD 0x89
+#define TL0 mcs51_sfr[0x8A]
+#define _TL0 0x8A
+#define TL1 mcs51_sfr[0x8B]
+#define _TL1 0x8B
+#define TH0 mcs51_sfr[0x8C]
+#define _TH0 0x8C
+#define TH1 mcs51_sfr[0x8D]
+#define _TH1 0x8D
+#define P1 mcs51_sfr[0x90]
+#define _P1 0x90
+#define SCON mcs51_sfr[0x98]
+#define _SCON 0x98
+#define SBUF mcs51_sfr[0x99]
+#define _SBUF 0x99
+#define P2 mcs51_sfr[0xA0]
+#define _P2 0xA0
+#define IE mcs51_sfr[0xA8]
+#define _IE 0xA8
+#define P3 mcs51_sfr[0xB0]
+#define _P3 0xB0
+#define IP mcs51_sfr[0xB8]
+#define _IP 0xB8
+#define PSW mcs51_sfr[0xD0]
+#define _PSW 0xD0
+#define ACC mcs51_sfr[0xE0]
+#define _ACC 0xE0
+#define B mcs51_sfr[0xF0]
+#define _B 0xF0
+
+#define P0_0 mcs51_bit(0x80)
+#define _P0_0 0x80
+#define P0_1 mcs51_bit(0x81)
+#define _P0_1 0x81
+#define P0_2 mcs51_bit(0x82)
+#define _P0_2 0x82
+#define P0_3 mcs51_bit(0x83)
+#define _P0_3 0x83
+#define P0_4 mcs51_bit(0x84)
+#define _P0_4 0x84
+#define P0_5 mcs51_bit(0x85)
+#define _P0_5 0x85
+#define P0_6 mcs51_bit(0x86)
+#define _P0_6 0x86
+#define P0_7 mcs51_bit(0x87)
+#define _P0_7 0x87
+
+#define IT0 mcs51_bit(0x88)
+#define _IT0 0x88
+#define IE0 mcs51_bit(0x89)
+#define _IE0 0x89
+#define IT1 mcs51_bit(0x8A)
+#define _IT1 0x8A
+#define IE1 mcs51_bit(0x8B)
+#define _IE1 0x8B
+#define TR0 mcs51_bit(0x8C)
+#define _TR0 0x8C
+#define TF0 mcs51_bit(0x8D)
+#define _TF0 0x8D
+#define TR1 mcs51_bit(0x8E)
+#define _TR1 0x8E
+#define TF1 mcs51_bit(0x8F)
+#define _TF1 0x8F
+
+#define P1_0 mcs51_bit(0x90)
+#define _P1_0 0x90
+#define P1_1 mcs51_bit(0x91)
+#define _P1_1 0x91
+#define P1_2 mcs51_bit(0x92)
+#define _P1_2 0x92
+#define P1_3 mcs51_bit(0x93)
+#define _P1_3 0x93
+#define P1_4 mcs51_bit(0x94)
+#define _P1_4 0x94
+#define P1_5 mcs51_bit(0x95)
+#define _P1_5 0x95
+#define P1_6 mcs51_bit(0x96)
+#define _P1_6 0x96
+#define P1_7 mcs51_bit(0x97)
+#define _P1_7 0x97
+
+#define RI mcs51_bit(0x98)
+#define _RI 0x98
+#define TI mcs51_bit(0x99)
+#define _TI 0x99
+#define RB8 mcs51_bit(0x9A)
+#define _RB8 0x9A
+#define TB8 mcs51_bit(0x9B)
+#define _TB8 0x9B
+#define REN mcs51_bit(0x9C)
+#define _REN 0x9C
+#define SM2 mcs51_bit(0x9D)
+#define _SM2 0x9D
+#define SM1 mcs51_bit(0x9E)
+#define _SM1 0x9E
+#define SM0 mcs51_bit(0x9F)
+#define _SM0 0x9F
+
+#define P2_0 mcs51_bit(0xA0)
+#define _P2_0 0xA0
+#define P2_1 mcs51_bit(0xA1)
+#define _P2_1 0xA1
+#define P2_2 mcs51_bit(0xA2)
+#define _P2_2 0xA2
+#define P2_3 mcs51_bit(0xA3)
+#define _P2_3 0xA3
+#define P2_4 mcs51_bit(0xA4)
+#define _P2_4 0xA4
+#define P2_5 mcs51_bit(0xA5)
+#define _P2_5 0xA5
+#define P2_6 mcs51_bit(0xA6)
+#define _P2_6 0xA6
+#define P2_7 mcs51_bit(0xA7)
+#define _P2_7 0xA7
+
+#define EX0 mcs51_bit(0xA8)
+#define _EX0 0xA8
+#define ET0 mcs51_bit(0xA9)
+#define _ET0 0xA9
+#define EX1 mcs51_bit(0xAA)
+#define _EX1 0xAA
+#define ET1 mcs51_bit(0xAB)
+#define _ET1 0xAB
+#define ES mcs51_bit(0xAC)
+#define _ES 0xAC
+#define EA mcs51_bit(0xAF)
+#define _EA 0xAF
+
+#define P3_0 mcs51_bit(0xB0)
+#define _P3_0 0xB0
+#define P3_1 mcs51_bit(0xB1)
+#define _P3_1 0xB1
+#define P3_2 mcs51_bit(0xB2)
+#define _P3_2 0xB2
+#define P3_3 mcs51_bit(0xB3)
+#define _P3_3 0xB3
+#define P3_4 mcs51_bit(0xB4)
+#define _P3_4 0xB4
+#define P3_5 mcs51_bit(0xB5)
+#define _P3_5 0xB5
+#define P3_6 mcs51_bit(0xB6)
+#define _P3_6 0xB6
+#define P3_7 mcs51_bit(0xB7)
+#define _P3_7 0xB7
+
+#define PX0 mcs51_bit(0xB8)
+#define _PX0 0xB8
+#define PT0 mcs51_bit(0xB9)
+#define _PT0 0xB9
+#define PX1 mcs51_bit(0xBA)
+#define _PX1 0xBA
+#define PT1 mcs51_bit(0xBB)
+#define _PT1 0xBB
+#define PS mcs51_bit(0xBC)
+#define _PS 0xBC
+
+#define OV mcs51_bit(0xD2)
+#define _OV 0xD2
+#define RS0 mcs51_bit(0xD3)
+#define _RS0 0xD3
+#define RS1 mcs51_bit(0xD4)
+#define _RS1 0xD4
+#define F0 mcs51_bit(0xD5)
+#define _F0 0xD5
+#define AC mcs51_bit(0xD6)
+#define _AC 0xD6
+#define CY mcs51_bit(0xD7)
+#define _CY 0xD7
+
+#endif
@@ -0,0 +1,120 @@
+// alarm and hourly chime scheduler
+//
+
+#include "alarm.h"
+#include "ds1302.h"
+
+// minute of day of next event and its type
+static uint16_t next_event = ALARM_NO_EVENT;
+static uint8_t  next_type;
+// minute of day expected at next rollover, anything else means the clock
+// was set/jumped or the schedule was invalidated
+static uint16_t expect_mod = ALARM_NO_EVENT;
+static uint8_t  last_minute = 0xFF;
+
+uint16_t alarm_minute_of_day() {
+    return ds_hour24() * 60 + ds_split2int(rtc_table[DS_ADDR_MINUTES] & DS_MASK_MINUTES);
+}
+
+// find first event at or after minute of day 'from'
+static void alarm_schedule(uint16_t from) {
+    uint16_t t, dist, best = MINUTES_PER_DAY;
+    uint8_t h, i, start, stop;
+
+    if (from == MINUTES_PER_DAY) from = 0;
+    next_event = ALARM_NO_EVENT;
+    next_type = ALARM_NONE;
+
+    if (CONF_ALARM_ON) {
+        t = (cfg_table[CFG_ALARM_HOURS_BYTE] >> 3) * 60 + (cfg_table[CFG_ALARM_MINUTES_BYTE] & CFG_ALARM_MINUTES_MASK);
+        best = (t + MINUTES_PER_DAY - from) % MINUTES_PER_DAY;
+        next_event = t;
+        next_type = ALARM_ALARM;
+    }
+
+    if (CONF_CHIME_ON) {
+        start = cfg_table[CFG_CHIME_START_BYTE] >> 3;
+        stop = cfg_table[CFG_CHIME_STOP_BYTE] & CFG_CHIME_STOP_MASK;
+        // first full hour at or after 'from' inside chime window (may wrap midnight)
+        h = (from + 59) / 60;
+        for (i=0; i!=24; i++, h++) {
+            if (h == 24) h = 0;
+            if (start <= stop ? (h >= start && h <= stop) : (h >= start || h <= stop))
+                break;
+        }
+        if (i != 24) {
+            t = h * 60;
+            dist = (t + MINUTES_PER_DAY - from) % MINUTES_PER_DAY;
+            // alarm wins a tie
+            if (dist < best) {
+                next_event = t;
+                next_type = ALARM_CHIME;
+            }
+        }
+    }
+}
+
+void alarm_reschedule() {
+    expect_mod = ALARM_NO_EVENT;
+}
+
+uint8_t alarm_check() {
+    uint16_t now;
+    uint8_t ev;
+
+    if (rtc_table[DS_ADDR_MINUTES] == last_minute)
+        return ALARM_NONE;
+    // minute rollover
+    last_minute = rtc_table[DS_ADDR_MINUTES];
+    now = alarm_minute_of_day();
+    if (now != expect_mod)
+        alarm_schedule(now);
+    expect_mod = now + 1;
+    if (expect_mod == MINUTES_PER_DAY) expect_mod = 0;
+
+    if (now != next_event)
+        return ALARM_NONE;
+    ev = next_type;
+    alarm_schedule(now + 1);
+    return ev;
+}
+
+void alarm_hour_incr() {
+    uint8_t hours = cfg_table[CFG_ALARM_HOURS_BYTE] >> 3;
+    if (hours < 23)
+        hours++;
+    else
+        hours = 0;
+    cfg_table[CFG_ALARM_HOURS_BYTE] = (cfg_table[CFG_ALARM_HOURS_BYTE] & ~CFG_ALARM_HOURS_MASK) | hours << 3;
+    alarm_reschedule();
+}
+
+void alarm_minute_incr() {
+    uint8_t minutes = cfg_table[CFG_ALARM_MINUTES_BYTE] & CFG_ALARM_MINUTES_MASK;
+    if (minutes < 59)
+        minutes++;
+    else
+        minutes = 0;
+    cfg_table[CFG_ALARM_MINUTES_BYTE] = (cfg_table[CFG_ALARM_MINUTES_BYTE] & ~CFG_ALARM_MINUTES_MASK) | minutes;
+    alarm_reschedule();
+}
+
+void chime_start_incr() {
+    uint8_t hours = cfg_table[CFG_CHIME_START_BYTE] >> 3;
+    if (hours < 23)
+        hours++;
+    else
+        hours = 0;
+    cfg_table[CFG_CHIME_START_BYTE] = (cfg_table[CFG_CHIME_START_BYTE] & ~CFG_CHIME_START_MASK) | hours << 3;
+    alarm_reschedule();
+}
+
+void chime_stop_incr() {
+    uint8_t hours = cfg_table[CFG_CHIME_STOP_BYTE] & CFG_CHIME_STOP_MASK;
+    if (hours < 23)
+        hours++;
+    else
+        hours = 0;
+    cfg_table[CFG_CHIME_STOP_BYTE] = (cfg_table[CFG_CHIME_STOP_BYTE] & ~CFG_CHIME_STOP_MASK) | hours;
+    alarm_reschedule();
+}
@@ -0,0 +1,134 @@
+// stopwatch and countdown timer
+//
+
+// chrono_tick() runs in the tick isr, locals must not share overlay space
+// with functions of the main loop
+
+
+#include "chrono.h"
+#include "stc15.h"
+
+volatile uint8_t chrono_up[3];
+volatile uint8_t chrono_down[3];
+volatile _Bool chrono_up_run;
+volatile _Bool chrono_down_run;
+volatile _Bool chrono_expired;
+_Bool chrono_lap_on;
+
+static uint8_t chrono_lap[3];
+// countdown start value, seconds / minutes
+static uint8_t chrono_preset[2] = { 0x00, 0x05 };
+
+// BCD byte + 1, wraps to 0 after max, returns the carry
+// isr only, its parameters are static (main loop uses bcd_next)
+static _Bool bcd_inc(volatile  uint8_t *b, uint8_t max) {
+    uint8_t v = *b;
+    if (v == max) {
+        *b = 0;
+        return 1;
+    }
+    v++;
+    if ((v & 0x0F) == 0x0A) v += 6;
+    *b = v;
+    return 0;
+}
+
+// BCD byte - 1, wraps to max below 0, returns the borrow
+static _Bool bcd_dec(volatile  uint8_t *b, uint8_t max) {
+    uint8_t v = *b;
+    if (v == 0) {
+        *b = max;
+        return 1;
+    }
+    if ((v & 0x0F) == 0) v -= 6;
+    *b = v - 1;
+    return 0;
+}
+
+// main loop side BCD + 1, wraps to 0 after max
+static uint8_t bcd_next(uint8_t v, uint8_t max) {
+    if (v == max) return 0;
+    v++;
+    if ((v & 0x0F) == 0x0A) v += 6;
+    return v;
+}
+
+_Bool chrono_tick() {
+    if (chrono_up_run)
+        if (bcd_inc(&chrono_up[CHRONO_HSEC], 0x99))
+            if (bcd_inc(&chrono_up[CHRONO_SEC], 0x59))
+                bcd_inc(&chrono_up[CHRONO_MIN], 0x99);
+
+    if (chrono_down_run) {
+        if (bcd_dec(&chrono_down[CHRONO_HSEC], 0x99))
+            if (bcd_dec(&chrono_down[CHRONO_SEC], 0x59))
+                bcd_dec(&chrono_down[CHRONO_MIN], 0x99);
+        if (!(chrono_down[CHRONO_HSEC] | chrono_down[CHRONO_SEC] | chrono_down[CHRONO_MIN])) {
+            chrono_down_run = 0;
+            chrono_expired = 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void chrono_read( uint8_t *t, uint8_t down)  {
+    volatile  uint8_t *c = down ? chrono_down : chrono_lap_on ? chrono_lap : chrono_up;
+    t[0] = c[0];
+    t[1] = c[1];
+    t[2] = c[2];
+}
+
+void chrono_up_start() {
+    chrono_up_run = !chrono_up_run;
+}
+
+void chrono_up_lap() {
+    if (chrono_up_run && !chrono_lap_on) {
+        chrono_read(chrono_lap, 0);
+        chrono_lap_on = 1;
+    } else if (chrono_up_run) {
+        chrono_lap_on = 0;
+    } else {
+        chrono_lap_on = 0;
+        chrono_up[CHRONO_HSEC] = chrono_up[CHRONO_SEC] = chrono_up[CHRONO_MIN] = 0;
+    }
+}
+
+static void chrono_down_load() {
+    chrono_down[CHRONO_HSEC] = 0;
+    chrono_down[CHRONO_SEC] = chrono_preset[0];
+    chrono_down[CHRONO_MIN] = chrono_preset[1];
+}
+
+void chrono_down_start() {
+    if (chrono_down_run) {
+        chrono_down_run = 0;
+        return;
+    }
+    if (!(chrono_down[CHRONO_HSEC] | chrono_down[CHRONO_SEC] | chrono_down[CHRONO_MIN]))
+        chrono_down_load();
+    // a 0:00 preset would borrow to 99:59.99 on the first tick, don't start
+    if (!(chrono_down[CHRONO_HSEC] | chrono_down[CHRONO_SEC] | chrono_down[CHRONO_MIN]))
+        return;
+    chrono_down_run = 1;
+}
+
+void chrono_down_edit() {
+    chrono_down_run = 0;
+    chrono_down_load();
+}
+
+void chrono_down_min_incr() {
+    chrono_down[CHRONO_MIN] = bcd_next(chrono_down[CHRONO_MIN], 0x99);
+}
+
+void chrono_down_sec_incr() {
+    chrono_down[CHRONO_SEC] = bcd_next(chrono_down[CHRONO_SEC], 0x59);
+}
+
+void chrono_down_set() {
+    chrono_down[CHRONO_HSEC] = 0;
+    chrono_preset[0] = chrono_down[CHRONO_SEC];
+    chrono_preset[1] = chrono_down[CHRONO_MIN];
+}
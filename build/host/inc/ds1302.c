@@ -0,0 +1,370 @@
+// DS1302 RTC IC
+// http://datasheets.maximintegrated.com/en/ds/DS1302.pdf
+//
+
+
+
+#include "ds1302.h"
+
+#ifdef LVD_FLUSH
+// ds_ram_writeburst is also called from the lvd isr
+
+
+volatile _Bool ds_lvd_armed;
+#endif
+
+uint8_t readbyte();
+void sendbyte(uint8_t b);
+
+// second magic byte: MAGIC_HI as the firmware before the history wrote it
+// (config only, the RAM behind it undefined), MAGIC_HIST once the history
+// area holds samples or HIST_EMPTY
+#define MAGIC_HI    0x5A
+#define MAGIC_HIST  0x5B
+#define MAGIC_LO    0xA5
+// unwritten history, HIST_EMPTY of history.h
+#define HIST_FILL   0xFF
+
+void ds_ram_config_init() {
+    uint8_t buf[6], i;
+    // magic and config in one burst, cut short after the config
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_READ);
+    for (i=0; i!=6; i++)
+        buf[i] = readbyte();
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+
+    // check magic bytes to see if ram has been written before, config of
+    // either layout is kept
+    if (buf[0] != MAGIC_LO || (buf[1] != MAGIC_HI && buf[1] != MAGIC_HIST)) {
+        // if not (first boot, battery lost): default config, empty history
+        ds_ram_writeburst(0, 0);
+        return;
+    }
+
+    // OPTIMISE : end condition of loop !=4 will generate less code than <4
+    for (i=0; i!=4; i++)
+        cfg_table[i] = buf[i + 2];
+}
+
+void ds_ram_config_write() {
+    uint8_t i,j;
+    j=DS_CMD_RAM>>1|2;
+    for (i=0; i!=4; i++)
+        ds_writebyte( j++, cfg_table[i]);
+}
+
+void ds_ram_writeburst( uint8_t *buf, uint8_t len) {
+    // ds1302 burst-write ram: magic, cfg_table, then len bytes from buf,
+    // the rest of the RAM as empty history
+    uint8_t i;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_WRITE);
+    sendbyte(MAGIC_LO);
+    sendbyte(MAGIC_HIST);
+    for (i=0; i!=4; i++)
+        sendbyte(cfg_table[i]);
+    for (i=DS_RAM_HIST; i!=DS_RAM_SIZE; i++) {
+        if (len) {
+            sendbyte(*buf++);
+            len--;
+        } else {
+            sendbyte(HIST_FILL);
+        }
+    }
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+}
+
+uint8_t ds_ram_readburst( uint8_t *buf, uint8_t len) {
+    // ds1302 burst-read ram: check magic, skip cfg, then len bytes into buf
+    uint8_t i, ok;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_READ);
+    ok = readbyte() == MAGIC_LO;
+    if (readbyte() != MAGIC_HIST) ok = 0;
+    for (i=0; i!=4; i++)
+        readbyte();
+    while (len--)
+        *buf++ = readbyte();
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+    return ok;
+}
+
+void sendbyte(uint8_t b)
+{ DPL = b;
+  b;
+  mcs51_asm(
+MCS51_LINE(push	ar7)
+MCS51_LINE(mov     a,dpl)
+MCS51_LINE(mov	r7,#8)
+MCS51_LINE(00001$:)
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(rrc     a)
+MCS51_LINE(mov     DS_ASM(DS_IO),c)
+MCS51_LINE(setb	DS_ASM(DS_SCLK))
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(clr	DS_ASM(DS_SCLK))
+MCS51_LINE(djnz	r7,00001$)
+MCS51_LINE(pop	ar7)
+);
+}
+
+uint8_t readbyte()
+{
+  mcs51_asm(
+MCS51_LINE(push	ar7)
+MCS51_LINE(mov 	a,#0)
+MCS51_LINE(mov 	r7,#8)
+MCS51_LINE(00002$:)
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(mov	c,DS_ASM(DS_IO))
+MCS51_LINE(rrc	a)
+MCS51_LINE(setb	DS_ASM(DS_SCLK))
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(clr	DS_ASM(DS_SCLK))
+MCS51_LINE(djnz	r7,00002$)
+MCS51_LINE(mov	dpl,a)
+MCS51_LINE(pop	ar7)
+);
+ return DPL;
+}
+
+uint8_t ds_readbyte(uint8_t addr) {
+    // ds1302 single-byte read
+    uint8_t b;
+    b = DS_CMD | DS_CMD_CLOCK | addr << 1 | DS_CMD_READ;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    // send cmd byte
+    sendbyte(b);
+    // read byte
+    b=readbyte();
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+    return b;
+}
+
+void ds_readburst() {
+    // ds1302 burst-read 8 bytes into struct
+    uint8_t b;
+    b = DS_CMD | DS_CMD_CLOCK | DS_BURST_MODE << 1 | DS_CMD_READ;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    // send cmd byte
+    sendbyte(b);
+    // read bytes, clocked in one loop instead of calling readbyte() per byte
+    // OPTIMISE : saves the lcall/ret, push/pop ar7 and indexed store of every byte
+  mcs51_asm(
+MCS51_LINE(mov	r0,#_rtc_table)
+MCS51_LINE(mov	r6,#8)
+MCS51_LINE(00003$:)
+MCS51_LINE(mov	r7,#8)
+MCS51_LINE(00004$:)
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(mov	c,DS_ASM(DS_IO))
+MCS51_LINE(rrc	a)
+MCS51_LINE(setb	DS_ASM(DS_SCLK))
+#ifndef DS_FASTIO
+MCS51_LINE(nop)
+MCS51_LINE(nop)
+#endif
+MCS51_LINE(clr	DS_ASM(DS_SCLK))
+MCS51_LINE(djnz	r7,00004$)
+MCS51_LINE(mov	@r0,a)
+MCS51_LINE(inc	r0)
+MCS51_LINE(djnz	r6,00003$)
+);
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+}
+
+void ds_writebyte(uint8_t addr, uint8_t data) {
+    // ds1302 single-byte write
+    uint8_t b = 0;
+    b = DS_CMD | DS_CMD_CLOCK | addr << 1 | DS_CMD_WRITE;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    // send cmd byte
+    sendbyte(b);
+    // send data byte
+    sendbyte(data);
+
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+}
+
+void ds_init() {
+    // one burst fills rtc_table, WP and CH are only written when set, so a
+    // running clock is not touched (a seconds write would restart the second)
+    ds_readburst();
+    if (rtc_table[DS_ADDR_WP])
+        ds_writebyte(DS_ADDR_WP, 0); // clear WP
+    if (rtc_table[DS_ADDR_SECONDS] & 0b10000000) {
+        rtc_table[DS_ADDR_SECONDS] &= ~(0b10000000);
+        ds_writebyte(DS_ADDR_SECONDS, rtc_table[DS_ADDR_SECONDS]); // clear CH
+    }
+}
+
+// reset date, time
+void ds_reset_clock() {
+    ds_writebyte(DS_ADDR_MINUTES, 0x00);
+    ds_writebyte(DS_ADDR_HOUR,  DS_MASK_AMPM_MODE|0x07);
+    ds_writebyte(DS_ADDR_MONTH, 0x01);
+    ds_writebyte(DS_ADDR_DAY,   0x01);
+}
+    
+void ds_hours_12_24_toggle() {
+
+    uint8_t hours,b;
+    if (H12_24)
+    { // 12h->24h
+      hours=ds_split2int(rtc_table[DS_ADDR_HOUR]&DS_MASK_HOUR12); // hours in 12h format (1-11am 12pm 1-11pm 12am)
+      if (hours==12) 
+       {if (!H12_PM) hours=0;}
+      else
+       {if (H12_PM) hours+=12;}			 // to 24h format
+      b = ds_int2bcd(hours);			 // clear hour_12_24 bit
+    }
+    else
+    { // 24h->12h 
+      hours = ds_split2int(rtc_table[DS_ADDR_HOUR]&DS_MASK_HOUR24); // hours in 24h format (0-23, 0-11=>am , 12-23=>pm)
+      b = DS_MASK_AMPM_MODE; 
+      if (hours >= 12) { hours-=12; b|=0x20; }	// pm
+      if (hours == 0) { hours=12; } 		//12am
+      b |= ds_int2bcd(hours);
+    }
+
+    ds_writebyte(DS_ADDR_HOUR,b);
+}
+
+// increment hours
+void ds_hours_incr() {
+    uint8_t hours, b = 0;
+    if (!H12_24) {
+        hours = ds_split2int(rtc_table[DS_ADDR_HOUR]&DS_MASK_HOUR24);	//24h format
+        if (hours < 23)
+            hours++;
+        else {
+            hours = 00;
+        }
+        b = ds_int2bcd(hours);		// bit 7 = 0
+    } else {
+        hours = ds_split2int(rtc_table[DS_ADDR_HOUR]&DS_MASK_HOUR12);	//12h format
+        if (hours < 12)
+            hours++;
+        else
+            hours = 1;
+        if (hours == 12)
+            H12_PM=!H12_PM;	// 11 -> 12 changes AM/PM, 12 -> 1 does not
+        b = (H12_PM?(DS_MASK_AMPM_MODE|DS_MASK_PM):DS_MASK_AMPM_MODE) | ds_int2bcd(hours);        
+    }
+    
+    ds_writebyte(DS_ADDR_HOUR, b);
+}
+
+// increment minutes
+void ds_minutes_incr() {
+    uint8_t minutes = ds_split2int(rtc_table[DS_ADDR_MINUTES]&DS_MASK_MINUTES);
+    if (minutes < 59)
+        minutes++;
+    else
+        minutes = 1;
+    ds_writebyte(DS_ADDR_MINUTES, ds_int2bcd(minutes));
+}
+
+// increment month
+void ds_month_incr() {
+    uint8_t month = ds_split2int(rtc_table[DS_ADDR_MONTH]&DS_MASK_MONTH);
+    if (month < 12)
+        month++;
+    else
+        month = 1;
+    ds_writebyte(DS_ADDR_MONTH, ds_int2bcd(month));
+}
+
+// increment day
+void ds_day_incr() {
+    uint8_t day = ds_split2int(rtc_table[DS_ADDR_DAY]&DS_MASK_DAY);
+    if (day < 31)
+        day++;
+    else
+        day = 1;
+    ds_writebyte(DS_ADDR_DAY, ds_int2bcd(day));
+}
+
+void ds_weekday_incr() {
+    uint8_t day = rtc_table[DS_ADDR_WEEKDAY];
+    if (day < 7)
+        day++;
+    else
+        day=1;
+    ds_writebyte(DS_ADDR_WEEKDAY, day);
+    rtc_table[DS_ADDR_WEEKDAY] = day;		// usefull ?
+}
+
+void ds_sec_zero() {
+    rtc_table[DS_ADDR_SECONDS]=0;
+    ds_writebyte(DS_ADDR_SECONDS,0);
+}
+    
+// hours in 24h format (0-23) whatever mode the rtc is in
+uint8_t ds_hour24() {
+    uint8_t hours;
+    if (H12_24) {
+        hours = ds_split2int(rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR12);   // 1-12
+        if (hours == 12) hours = 0;
+        if (H12_PM) hours += 12;
+        return hours;
+    }
+    return ds_split2int(rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR24);
+}
+
+uint8_t ds_split2int(uint8_t tens_ones) {
+    return (tens_ones>>4) * 10 + (tens_ones&0xF);
+}
+
+// return bcd byte from integer
+uint8_t ds_int2bcd(uint8_t integer) {
+    return integer / 10 << 4 | integer % 10;
+}
+
+uint8_t ds_int2bcd_tens(uint8_t integer) {
+    return integer / 10 % 10;
+}
+
+uint8_t ds_int2bcd_ones(uint8_t integer) {
+    return integer % 10;
+}
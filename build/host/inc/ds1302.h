@@ -0,0 +1,227 @@
+// DS1302 RTC IC
+// http://datasheets.maximintegrated.com/en/ds/DS1302.pdf
+//
+
+#include "stc15.h"
+#include <stdint.h>
+
+#define _nop_ mcs51_asm(MCS51_LINE(nop));
+
+// With GPS_UART2 the GPS takes UART2 on its default pins RxD2/TxD2 = P1.0/P1.1
+// (the P4.6/P4.7 alternative is not bonded out on the 28 pin 408AS), CE and IO
+// are rewired to P5.5 (J01) and P5.4, the only spare pins of that package.
+// P5.4 doubles as RST, flash with the reset pin disabled. DS1302_P5 states
+// the board has that rework, an image without it would lose the rtc.
+#if defined(GPS_UART2) && !defined(DS1302_P5)
+#error "GPS_UART2 needs the DS1302 rewired to P5.5/P5.4, add DS1302_P5 to FEATURES"
+#endif
+#ifdef DS1302_P5
+#define DS_CE    P5_5
+#define DS_IO    P5_4
+#else
+#define DS_CE    P1_0
+#define DS_IO    P1_1
+#endif
+#define DS_SCLK  P1_2
+
+// pin as asm symbol, DS_ASM(DS_IO) -> _P1_1, keeps the transfer loops on the
+// pins above
+#define DS_ASM_(pin) _##pin
+#define DS_ASM(pin)  DS_ASM_(pin)
+
+// DS1302 pins are not routed to SPI capable pins on either revision (SPI is on
+// P1.2-P1.5 / P2.1-P2.4 and collides with SCLK, SW3/LED and the segment lines),
+// so the bus is always bit-banged.
+// With DS_FASTIO the nop padding around SCLK is dropped: on the 1T core setb/clr
+// already keep SCLK high/low for 3 clocks (~270ns @ 11.0592MHz), which meets
+// tCH/tCL (250ns) and tCDD (200ns) at 5V. Default for the 408AS revision,
+// build with -DDS_SLOWIO to keep the padded timing.
+#if defined(stc15w408as) && !defined(DS_SLOWIO)
+#define DS_FASTIO
+#endif
+
+#define DS_CMD        1 << 7
+#define DS_CMD_READ   1
+#define DS_CMD_WRITE  0
+#define DS_CMD_RAM    1 << 6
+#define DS_CMD_CLOCK  0 << 6
+
+#define DS_ADDR_SECONDS     0
+#define DS_ADDR_MINUTES     1
+#define DS_ADDR_HOUR        2
+#define DS_ADDR_DAY         3
+#define DS_ADDR_MONTH       4
+#define DS_ADDR_WEEKDAY     5
+#define DS_ADDR_YEAR        6
+#define DS_ADDR_WP          7
+#define DS_ADDR_TCSDS       8
+
+#define DS_BURST_MODE       31
+
+// DS_ADDR_SECONDS	c111_1111	0_0-5_9 c=clock_halt
+// DS_ADDR_MINUTES	x111_1111	0_0-5_9
+// DS_ADDR_HOUR		a0b1_1111	0_1-1_2/0_0-2_3 - a=12/not 24, b=not AM/PM if a=1 , else hour(0x20) 
+// DS_ADDR_DAY          0011_1111	0_1-3_1
+// DS_ADDR_MONTH        0001_1111	0_1-1_2
+// DS_ADDR_WEEKDAY      0000_0111	0_1-0_7
+// DS_ADDR_YEAR		1111_1111	0_0-9_9 
+
+#define DS_MASK_SECONDS       0b01111111
+#define DS_MASK_SECONDS_TENS  0b01110000
+#define DS_MASK_SECONDS_UNITS 0b00001111
+#define DS_MASK_MINUTES       0b01111111
+#define DS_MASK_MINUTES_TENS  0b01110000
+#define DS_MASK_MINUTES_UNITS 0b00001111
+#define DS_MASK_AMPM_MODE     0b10000000
+#define DS_MASK_PM            0b00100000
+#define DS_MASK_HOUR12        0b00011111
+#define DS_MASK_HOUR12_TENS   0b00010000
+#define DS_MASK_HOUR24        0b00111111
+#define DS_MASK_HOUR24_TENS   0b00110000
+#define DS_MASK_HOUR_UNITS    0b00001111
+#define DS_MASK_DAY           0b00111111
+#define DS_MASK_DAY_TENS      0b00110000
+#define DS_MASK_DAY_UNITS     0b00001111
+#define DS_MASK_MONTH         0b00011111
+#define DS_MASK_MONTH_TENS    0b00010000
+#define DS_MASK_MONTH_UNITS   0b00001111
+#define DS_MASK_WEEKDAY       0b00000111
+#define DS_MASK_YEAR          0b11111111
+#define DS_MASK_YEAR_TENS     0b11110000
+#define DS_MASK_YEAR_UNITS    0b00001111
+
+/* 
+  NB: the rtc and config bits below were originally structs/unions, but for some reason 
+  the resulting code was bloated coming out of sdcc. This is attempt to recreate this
+  struct/union functionality directly, by explicit selection of bit/byte iram addressing
+  and using masks above. Because this current implementation is much more complex than
+  dealing with structs/unions, would like to someday return to simpler struct/union access
+  if code size allows (sdcc optimizations?).
+*/
+
+// 8051 zone from 0x20 and 0x2F in IRAM can be accessed as bit (between 0x00 and 0x7F)
+// 0x20, bit 0 is _Bool , bit 7 is _Bool  etc...
+
+#define rtc_table (*(uint8_t (*)[8])(mcs51_iram + 0x24))
+#define _rtc_table 0x24
+
+// h12.tenhour in RTC is at address 0x26, bit 4 -> => 0x26-0x20 => 0x6*8+4 => 52 => 0x34
+#define H12_TH mcs51_bit(0x34)
+#define _H12_TH 0x34
+// h12.pm in RTC is at address 0x26, bit 5 -> => 0x26-0x20 => 0x6*8+5 => 53 => 0x35
+#define H12_PM mcs51_bit(0x35)
+#define _H12_PM 0x35
+// hour_12_24 in RTC is at address 0x26, bit 7 -> => 0x26-0x20 => 0x6*8+7 => 55 => 0x37
+#define H12_24 mcs51_bit(0x37)
+#define _H12_24 0x37
+
+// DS1302 RAM layout: magic (2) / cfg_table (4) / history (25), see history.h
+
+#define DS_RAM_MAGIC  0
+#define DS_RAM_CFG    2
+#define DS_RAM_HIST   6
+#define DS_RAM_SIZE   31
+
+// config in DS1302 RAM
+
+#define cfg_table (*(uint8_t (*)[4])(mcs51_iram + 0x2c))
+#define _cfg_table 0x2c
+
+#define CFG_ALARM_HOURS_BYTE   0
+#define CFG_ALARM_MINUTES_BYTE 1
+#define CFG_TEMP_BYTE          2
+#define CFG_CHIME_START_BYTE   2
+#define CFG_CHIME_STOP_BYTE    3
+
+#define CFG_ALARM_HOURS_MASK   0b11111000
+#define CFG_ALARM_MINUTES_MASK 0b00111111
+#define CFG_TEMP_MASK          0b00000111
+#define CFG_CHIME_START_MASK   0b11111000
+#define CFG_CHIME_STOP_MASK    0b00011111
+
+// Offset 0 => alarm_hour (7..3) / chime_on (2) / alarm_on (1) / temp_C_F (0)
+// Offset 1 => (7) not used / (6) sw_mmdd / alarm_minute (5..0)
+// Offset 2 => chime_hour_start (7..3) / temp_offset (2..0), signed -4 / +3
+// Offset 3 => (7),(6)&(5) not used / chime_hour_stop (4..0)
+
+// temp_C_F in config is at address 0x2c, bit 0 => 0x2c-0x20 => 0xc*8+0 => 96 => 0x60
+#define CONF_C_F mcs51_bit(0x60)
+#define _CONF_C_F 0x60
+#define CONF_ALARM_ON mcs51_bit(0x61)
+#define _CONF_ALARM_ON 0x61
+#define CONF_CHIME_ON mcs51_bit(0x62)
+#define _CONF_CHIME_ON 0x62
+#define CONF_SW_MMDD mcs51_bit(0x6E)
+#define _CONF_SW_MMDD 0x6E
+
+// LVD_FLUSH: the lvd isr writes DS1302 RAM, main loop transfers mask it so
+// the isr never cuts into one (<0.2ms delay). ds_lvd_armed is cleared while a
+// flush is done and the supply not back yet
+#ifdef LVD_FLUSH
+extern volatile _Bool ds_lvd_armed;
+#define DS_LVD_HOLD()     (ELVD = 0)
+#define DS_LVD_RELEASE()  (ELVD = ds_lvd_armed)
+#else
+#define DS_LVD_HOLD()
+#define DS_LVD_RELEASE()
+#endif
+
+// DS1302 Functions
+
+void ds_ram_config_init();
+void ds_ram_config_write();
+
+// ds1302 burst-write ram: magic, cfg_table, then len bytes from buf, HIST_EMPTY
+// up to the end of the RAM
+void ds_ram_writeburst( uint8_t *buf, uint8_t len);
+
+// ds1302 burst-read ram: len bytes after cfg into buf, returns 0 if magic is
+// missing or from before the history (the bytes are undefined then)
+uint8_t ds_ram_readburst( uint8_t *buf, uint8_t len);
+
+// ds1302 single-byte read
+uint8_t ds_readbyte(uint8_t addr);
+
+// ds1302 burst-read 8 bytes into struct
+void ds_readburst();
+
+// ds1302 single-byte write
+void ds_writebyte(uint8_t addr, uint8_t data);
+
+// burst read into rtc_table, clear WP, CH if set
+void ds_init();
+
+// reset date/time to 01/01 00:00
+void ds_reset_clock();
+
+// toggle 12/24 hour mode
+void ds_hours_12_24_toggle();
+    
+// increment hours
+void ds_hours_incr();
+
+// increment minutes
+void ds_minutes_incr();
+
+// increment month
+void ds_month_incr();
+
+// increment day
+void ds_day_incr();
+
+void ds_weekday_incr();
+void ds_sec_zero();
+    
+// hours in 24h format (0-23) from rtc_table
+uint8_t ds_hour24();
+
+// split bcd to int
+uint8_t ds_split2int(uint8_t tens_ones);
+
+// return bcd byte from integer
+uint8_t ds_int2bcd(uint8_t integer);
+    
+// convert integer to bcd parts (high = tens, low = ones)
+uint8_t ds_int2bcd_tens(uint8_t integer);
+uint8_t ds_int2bcd_ones(uint8_t integer);
+    
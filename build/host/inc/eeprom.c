@@ -0,0 +1,147 @@
+// STC15 IAP/EEPROM
+// config log: every change of cfg_table is appended as a new record, the
+// sector is erased only when it is full. Boot locates the last record.
+//
+
+#include "eeprom.h"
+#include "ds1302.h"
+#include "tz.h"
+
+// offset of the next free record and of the last valid one in the config sector
+uint16_t ee_next;
+uint16_t ee_last;
+
+uint8_t cfg_ext[CFG_EXT_SIZE];
+
+ uint8_t cfg_ext_default[CFG_EXT_SIZE] = {
+    TZ_RULE_DEFAULT
+};
+
+// record payload: cfg_table, then cfg_ext
+static uint8_t *cfg_byte(uint8_t i) {
+    return i < 4 ? &cfg_table[i] : &cfg_ext[i - 4];
+}
+
+static void iap_trigger(uint16_t addr) {
+    IAP_ADDRL = addr;
+    IAP_ADDRH = addr >> 8;
+    IAP_TRIG = 0x5A;
+    IAP_TRIG = 0xA5;
+    _nop_;
+}
+
+static void iap_idle() {
+    // disable IAP and point it outside of EEPROM, so nothing can be triggered by accident
+    IAP_CONTR = 0;
+    IAP_CMD = IAP_CMD_IDLE;
+    IAP_TRIG = 0;
+    IAP_ADDRH = 0x80;
+    IAP_ADDRL = 0;
+}
+
+uint8_t ee_readbyte(uint16_t addr) {
+    uint8_t b;
+    IAP_CONTR = IAP_ENABLE;
+    IAP_CMD = IAP_CMD_READ;
+    iap_trigger(addr);
+    b = IAP_DATA;
+    iap_idle();
+    return b;
+}
+
+void ee_writebyte(uint16_t addr, uint8_t data) {
+    IAP_CONTR = IAP_ENABLE;
+    IAP_CMD = IAP_CMD_PROGRAM;
+    IAP_DATA = data;
+    iap_trigger(addr);
+    iap_idle();
+}
+
+void ee_erase(uint16_t addr) {
+    IAP_CONTR = IAP_ENABLE;
+    IAP_CMD = IAP_CMD_ERASE;
+    iap_trigger(addr);
+    iap_idle();
+}
+
+void ee_config_init() {
+    uint8_t lo = 0, hi = EE_REC_COUNT, mid, i;
+    uint16_t a;
+
+    // records are only ever appended and a torn one is marked dead, so used
+    // slots are a prefix of the sector: binary search for the first erased magic
+    while (lo != hi) {
+        mid = (lo + hi) >> 1;
+        if (ee_readbyte(EE_CFG_SECTOR + mid * EE_REC_SIZE) != 0xFF)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    ee_next = lo * EE_REC_SIZE;
+
+    if (lo != EE_REC_COUNT) {
+        // magic is written last: a record torn by power loss has erased magic
+        // but a dirty payload and can't be programmed again, mark it dead
+        a = EE_CFG_SECTOR + ee_next + EE_REC_CFG;
+        for (i=0; i!=EE_REC_PAYLOAD; i++)
+            if (ee_readbyte(a++) != 0xFF) {
+                ee_writebyte(EE_CFG_SECTOR + ee_next, EE_REC_DEAD);
+                ee_next += EE_REC_SIZE;
+                break;
+            }
+    }
+
+    // last valid record, dead ones in between are skipped
+    ee_last = EE_REC_NONE;
+    for (a = ee_next; a != 0; ) {
+        a -= EE_REC_SIZE;
+        if (ee_readbyte(EE_CFG_SECTOR + a) == EE_REC_MAGIC) {
+            ee_last = a;
+            break;
+        }
+    }
+
+    if (ee_last == EE_REC_NONE) {
+        // nothing logged yet, take over config from DS1302 RAM
+        for (i=0; i!=CFG_EXT_SIZE; i++)
+            cfg_ext[i] = cfg_ext_default[i];
+        ds_ram_config_init();
+        return;
+    }
+
+    a = EE_CFG_SECTOR + ee_last + EE_REC_CFG;
+    for (i=0; i!=EE_REC_PAYLOAD; i++)
+        *cfg_byte(i) = ee_readbyte(a++);
+}
+
+void ee_config_save() {
+    uint8_t i;
+    uint16_t a;
+
+    // compare against last valid record, no DS1302 bus traffic
+    if (ee_last != EE_REC_NONE) {
+        a = EE_CFG_SECTOR + ee_last + EE_REC_CFG;
+        for (i=0; i!=EE_REC_PAYLOAD; i++)
+            if (ee_readbyte(a++) != *cfg_byte(i))
+                break;
+        if (i == EE_REC_PAYLOAD)
+            return;
+    }
+
+    if (ee_next == EE_SECTOR_SIZE) {
+        // power loss from here to the commit below loses cfg_ext, see eeprom.h
+        ee_erase(EE_CFG_SECTOR);
+        ee_next = 0;
+    }
+
+    a = EE_CFG_SECTOR + ee_next;
+    for (i=0; i!=EE_REC_PAYLOAD; i++)
+        ee_writebyte(a + EE_REC_CFG + i, *cfg_byte(i));
+    // commit record
+    ee_writebyte(a, EE_REC_MAGIC);
+    ee_last = ee_next;
+    ee_next += EE_REC_SIZE;
+
+    // keep DS1302 RAM cache in sync
+    ds_ram_config_write();
+}
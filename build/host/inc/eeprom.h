@@ -0,0 +1,64 @@
+// STC15 IAP/EEPROM
+// config log kept in on-chip EEPROM, DS1302 RAM is only used as a cache
+//
+
+#include "stc15.h"
+#include <stdint.h>
+
+#define _nop_ mcs51_asm(MCS51_LINE(nop));
+
+// IAP_CONTR: enable + wait time for SYSCLK < 12MHz
+#define IAP_ENABLE      0x83
+
+#define IAP_CMD_IDLE    0
+#define IAP_CMD_READ    1
+#define IAP_CMD_PROGRAM 2
+#define IAP_CMD_ERASE   3
+
+// EEPROM sector 0 (0x1000 in code space) holds the ledtables on the stc15f204ea,
+// config records are appended to sector 1
+#define EE_SECTOR_SIZE  512
+#define EE_CFG_SECTOR   0x0200
+
+// record: magic (written last, marks the record valid) / cfg_table[4] / cfg_ext
+// a record torn by power loss gets EE_REC_DEAD as magic at the next boot, so
+// used slots stay a prefix of the sector
+#define EE_REC_SIZE     16
+#define EE_REC_COUNT    (EE_SECTOR_SIZE / EE_REC_SIZE)
+#define EE_REC_MAGIC    0x5A
+#define EE_REC_DEAD     0x00
+#define EE_REC_NONE     0xFFFF
+#define EE_REC_CFG      1
+#define EE_REC_PAYLOAD  (EE_REC_SIZE - 1)
+
+// config not fitting in cfg_table, only kept in eeprom
+// 0..5 : timezone rule (see tz.h)
+// 6..7 : RC oscillator clock / 256 (see cal.h), 0 when not calibrated
+// 8..10: crystal turnover C / k 0.001ppm/C^2 / aging 0.1ppm (see drift.h),
+//        set on the drift screen with DRIFT_COMP
+// There is no second free sector on the STC15F204EA (sector 0 holds the
+// ledtables) and no room left in DS1302 RAM, so cfg_ext has no backup: power
+// lost between the erase of a full sector and the next commit (every 32
+// changes) brings back the defaults, the RC clock is then measured again
+#define CFG_EXT_TZ      0
+#define CFG_EXT_CAL     6
+#define CFG_EXT_DRIFT   8
+#define CFG_EXT_SIZE    (EE_REC_PAYLOAD - 4)
+extern uint8_t cfg_ext[CFG_EXT_SIZE];
+
+// IAP single-byte read
+uint8_t ee_readbyte(uint16_t addr);
+
+// IAP single-byte program, byte must be erased (0xFF) before
+void ee_writebyte(uint16_t addr, uint8_t data);
+
+// IAP sector erase
+void ee_erase(uint16_t addr);
+
+// locate last valid config record and load cfg_table/cfg_ext from it, marks
+// a torn record dead; falls back to DS1302 RAM config and cfg_ext defaults
+// if the log holds no valid record
+void ee_config_init();
+
+// append cfg_table/cfg_ext as new record if it changed, refresh DS1302 RAM cache
+void ee_config_save();
@@ -0,0 +1,23 @@
+// GPS receiver setup at boot (GPS_CONFIG): only ZDA and RMC, every GPS_RATE
+// fixes, instead of the 5-8 sentence types modules send by default.
+// PMTK314 (MediaTek) and UBX CFG-MSG (u-blox) are both sent, a module
+// ignores the other vendor's command. Checksums are computed while sending.
+//
+
+#include <stdint.h>
+
+#if defined(GPS_CONFIG) && !defined(TELEMETRY)
+#error "GPS_CONFIG sends through telemetry, enable TELEMETRY too"
+#endif
+
+// output every n-th fix, keep <= 10 so a ZDA falls in the :30-:40 adjust window
+#ifndef GPS_RATE
+#define GPS_RATE    1
+#endif
+
+// send the configuration, interrupts must be on (UART1 goes through telemetry)
+void gps_configure(void);
+
+// once a minute: rx bytes/s, sentences and ZDA sentences of the last minute
+// on telemetry, counters are cleared
+void gps_report(void);
@@ -0,0 +1,37 @@
+// temperature history
+// one sample per hour for the last 24 hours plus daily min/max, kept in
+// battery backed DS1302 RAM behind the config
+//
+
+#include <stdint.h>
+
+#define HIST_HOURS        24
+// sample = temp + offset, covers -40..+214
+#define HIST_TEMP_OFFSET  40
+#define HIST_EMPTY        0xFF
+
+// samples by hour of day, last byte is the ring index (hour of newest sample)
+// layout matches DS1302 RAM from DS_RAM_HIST on, written in one burst
+#define HIST_INDEX        HIST_HOURS
+extern  uint8_t hist_table[HIST_HOURS + 1];
+
+// daily min/max, encoded as samples
+extern uint8_t hist_min;
+extern uint8_t hist_max;
+
+#ifdef HISTORY
+
+// load history from DS1302 RAM (one burst read), seed today's min/max
+void hist_init();
+
+// feed a temperature reading; on hour rollover the sample is stored and
+// history written back in one burst, min/max restart at midnight
+void hist_update(uint8_t temp);
+
+// sample of n hours before the newest one
+uint8_t hist_sample(uint8_t n);
+
+#else
+#define hist_init()
+#define hist_update(temp)
+#endif
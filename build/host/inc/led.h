@@ -0,0 +1,33 @@
+// LED functions for 4-digit seven segment led
+
+#include <stdint.h>
+
+// ledtable[]/ledtable2[] and LED_x glyph indexes are generated from
+// src/glyphs.def by tools/ledgen.py
+#include "ledtable.h"
+
+uint8_t tmpbuf[4];
+_Bool   dot0;
+_Bool   dot1;
+_Bool   dot2;
+_Bool   dot3;
+
+// two display frames, timer0 isr shows dbuf[dbuf_front .. dbuf_front+3]
+// a frame is rendered into the back one and published by flipping dbuf_front,
+// a single byte write, so no interrupt masking is needed
+uint8_t dbuf[8];
+volatile uint8_t dbuf_front;
+
+#define clearTmpDisplay() { dot0=0; dot1=0; dot2=0; dot3=0; tmpbuf[0]=tmpbuf[1]=tmpbuf[2]=tmpbuf[3]=LED_BLANK; }
+
+#define filldisplay(pos,val,dp) { tmpbuf[pos]=(uint8_t)(val); if (dp) dot##pos=1;}
+#define dotdisplay(pos,dp) { if (dp) dot##pos=1;}
+
+// segments of one digit into back frame, table and dp bit of the digit are
+// resolved at compile time
+#define renderdigit(pos) { tmp=LEDTABLE(pos)[tmpbuf[pos]]; if (dot##pos) tmp&=LEDDP(pos); dbuf[back+pos]=tmp; }
+
+#define updateTmpDisplay() { uint8_t tmp, front=dbuf_front, back=front^4; \
+                        renderdigit(0); renderdigit(1); renderdigit(2); renderdigit(3); \
+                        if (dbuf[back]!=dbuf[front] || dbuf[back+1]!=dbuf[front+1] || \
+                            dbuf[back+2]!=dbuf[front+2] || dbuf[back+3]!=dbuf[front+3]) dbuf_front=back; }
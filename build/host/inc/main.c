@@ -0,0 +1,1334 @@
+//
+// STC15F204EA DIY LED Clock
+// Copyright 2016, Jens Jensen
+//
+
+#include "stc15.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "adc.h"
+#include "ds1302.h"
+#include "eeprom.h"
+#include "alarm.h"
+#include "tone.h"
+#include "history.h"
+#include "tz.h"
+#include "msg.h"
+#include "nmea.h"
+#include "cal.h"
+#include "telemetry.h"
+#include "gps.h"
+#include "drift.h"
+#include "chrono.h"
+#include "led.h"
+
+// clear wdt
+#define WDT_CLEAR()    (WDT_CONTR |= 1 << 4)
+
+// alias for relay output, using relay to drive led for indication of main loop status
+// only for revision with stc15f204ea, buzzer alias is in tone.h
+#ifdef stc15f204ea
+#define RELAY   P1_4
+#else // revision with stc15w408as
+#define RELAY   P1_4
+#define LED     P1_5
+#endif
+
+// GPS on UART2 (P1.0/P1.1), UART1 left to telemetry/commands. The DS1302
+// CE/IO lines move to P5.5/P5.4 with it, see ds1302.h
+#if defined(GPS_UART2) && !defined(stc15w408as)
+#error "GPS_UART2 needs the stc15w408as, the stc15f204ea has no UART2"
+#endif
+
+// adc channels for sensors
+#define ADC_LIGHT 6
+#define ADC_TEMP  7
+
+// button switch aliases
+// SW3 only for revision with stc15w408as
+#ifdef stc15w408as
+#define SW3     P1_4
+#define S3      2
+#endif
+#define SW2     P3_0
+#define S2      1
+#define SW1     P3_1
+#define S1      0
+
+// display mode states
+// index into kstates[], keep in the same order
+enum keyboard_mode {
+  K_NORMAL,
+  K_SET_HOUR,
+  K_SET_MINUTE,
+  K_SET_HOUR_12_24,
+  K_SEC_DISP,
+  K_TEMP_DISP,
+#ifdef HISTORY
+  K_HIST_DISP,
+#endif
+  K_DATE_DISP,
+  K_SET_MONTH,
+  K_SET_DAY,
+  K_WEEKDAY_DISP,
+#ifdef TZ_SELECT
+  K_TZ_DISP,
+#endif
+#ifdef DRIFT_COMP
+  K_DRIFT_DISP,
+  K_SET_DRIFT,
+#endif
+#ifdef ALARM
+  K_ALARM_DISP,
+  K_SET_ALARM_HOUR,
+  K_SET_ALARM_MINUTE,
+  K_CHIME_DISP,
+  K_SET_CHIME_START,
+  K_SET_CHIME_STOP,
+#endif
+#ifdef CHRONO
+  K_STOPWATCH,
+  K_COUNTDOWN,
+  K_SET_COUNTDOWN_MIN,
+  K_SET_COUNTDOWN_SEC,
+#endif
+#ifdef DEBUG
+  K_DEBUG,
+#endif
+  K_COUNT,
+  K_STAY = 0xFF       // transition keeps current state
+};
+
+// S2 cycles through the displays, a display group left out of the build
+// hands over to the next one
+#ifdef CHRONO
+#define K_CHRONO_GROUP  K_STOPWATCH
+#else
+#define K_CHRONO_GROUP  K_NORMAL
+#endif
+#ifdef ALARM
+#define K_ALARM_GROUP   K_ALARM_DISP
+#else
+#define K_ALARM_GROUP   K_CHRONO_GROUP
+#endif
+#ifdef DRIFT_COMP
+#define K_DRIFT_GROUP   K_DRIFT_DISP
+#else
+#define K_DRIFT_GROUP   K_ALARM_GROUP
+#endif
+#ifdef TZ_SELECT
+#define K_TZ_GROUP      K_TZ_DISP
+#else
+#define K_TZ_GROUP      K_DRIFT_GROUP
+#endif
+#ifdef HISTORY
+#define K_HIST_GROUP    K_HIST_DISP
+#else
+#define K_HIST_GROUP    K_DATE_DISP
+#endif
+
+// keyboard events, index into kstate next[]/action[]
+enum keyboard_event {
+  E_S1,               // S1 pressed, repeats while held
+  E_S1_LONG,          // S1 released after long press
+  E_S2,               // S2 pressed, repeats while held
+  E_COUNT,
+  E_NONE = 0xFF
+};
+
+// digit pair flashed (and edited) by a state
+enum keyboard_flash {
+  F_NONE,
+  F_01,
+  F_23
+};
+
+// display mode states
+enum display_mode {
+  M_NORMAL,
+  M_SET_HOUR_12_24,
+  M_SEC_DISP,
+  M_TEMP_DISP,
+  M_HIST_DISP,
+  M_DATE_DISP,
+  M_WEEKDAY_DISP,
+  M_TZ_DISP,
+  M_DRIFT_DISP,
+  M_ALARM_DISP,
+  M_CHIME_DISP,
+  M_STOPWATCH,
+  M_COUNTDOWN,
+  M_DEBUG
+};
+
+
+// minutes since last gps time, GPS_NEVER until the first one
+#define GPS_NEVER 0xFF
+#define GPS_LOST  10
+uint8_t gps_age = GPS_NEVER;
+uint8_t gps_minute;
+
+/* ------------------------------------------------------------------------- */
+
+//date functions
+uint16_t get_days()
+{
+	return tz_days(ds_split2int(gpstm_table[DS_ADDR_YEAR]), ds_split2int(gpstm_table[DS_ADDR_MONTH]), ds_split2int(gpstm_table[DS_ADDR_DAY]));
+}
+
+void set_days(uint16_t days)
+{
+	uint8_t year = days / 366;
+	uint16_t day = days % 366;
+	uint8_t month = 0;
+	uint8_t leap_years = (year >> 2) + ((year & 0x3) ? 1 : 0);
+	day += year - leap_years;
+	while (1) {
+		uint8_t m_days = month_days[month] + ((month == 1 && (year & 0x3) == 0) ? 1 : 0);
+		if (day <= m_days) {
+			break;
+		}
+		day -= m_days;
+		month++;
+		if (month == 12) {
+			year++;
+			month = 0;
+		};
+	};
+
+	gpstm_table[DS_ADDR_DAY] = ds_int2bcd(day);
+	gpstm_table[DS_ADDR_MONTH] = ds_int2bcd(month + 1);
+	gpstm_table[DS_ADDR_YEAR] = ds_int2bcd(year);
+	gpstm_table[DS_ADDR_WEEKDAY] = (days + 4) % 7 + 1;
+}
+
+void adjust_timezone()
+{
+	int16_t minutes = ds_split2int(gpstm_table[DS_ADDR_HOUR]) * 60 + ds_split2int(gpstm_table[DS_ADDR_MINUTES]);
+	uint16_t days = get_days();
+
+	// offset from rule, one comparison unless a transition was crossed
+	minutes += tz_bias(ds_split2int(gpstm_table[DS_ADDR_YEAR]), days, minutes);
+	if (minutes < 0) {
+		days--;
+		minutes += 1440;
+	} else if (minutes >= 1440) {
+		days++;
+		minutes -= 1440;
+	};
+
+	gpstm_table[DS_ADDR_MINUTES] = ds_int2bcd(minutes % 60);
+	gpstm_table[DS_ADDR_HOUR] = ds_int2bcd(minutes / 60);
+	set_days(days);
+}
+/* ------------------------------------------------------------------------- */
+
+
+void _delay_ms(uint8_t ms)
+{ DPL = ms;
+  // delay function, tuned for 11.092 MHz clock
+  // optimized to assembler
+  ms; // keep compiler from complaining?
+  mcs51_asm(
+MCS51_LINE(delay$ :)
+MCS51_LINE(mov	b, #8)
+MCS51_LINE(outer$ :)
+MCS51_LINE(mov	a, #243)
+MCS51_LINE(inner$ :)
+MCS51_LINE(djnz acc, inner$)
+MCS51_LINE(djnz b, outer$)
+MCS51_LINE(djnz dpl, delay$)
+);
+}
+
+// GLOBALS
+uint8_t  count;     // was uint16 - 8 seems to be enough
+uint16_t temp;      // temperature sensor value
+uint8_t  lightval = 4;  // light sensor value, display on 4 of lightval refresh ticks
+uint16_t  raw_lightval;  // light sensor value
+
+volatile uint8_t displaycounter;
+#define TICK_DIV 100    // 100us refresh ticks per 10ms tick
+volatile uint8_t tick_div = TICK_DIV;  // refresh ticks left to the next 10ms tick
+volatile uint8_t _10ms_count;
+
+uint8_t dmode = M_NORMAL;     // display mode state
+uint8_t kmode = K_NORMAL;
+_Bool   kwait;                // S1 held where long press matters, decided on release
+#ifdef HISTORY
+uint8_t hist_cursor;          // history display: 0 min, 1 max, 2.. hours back
+#endif
+
+volatile _Bool  display_colon;         // flash colon
+_Bool  flash_01;
+_Bool  flash_23;
+_Bool  beep = 1;
+volatile _Bool booted;        // deferred setup done, see end of loop
+#ifdef TELEMETRY
+volatile uint16_t boot_ticks; // 10ms ticks from Timer0Init to the first frame
+#endif
+
+// alarm: loops left to repeat the alarm melody
+#define RING_ALARM 250
+uint8_t ring;
+
+#ifdef BUZZER
+ uint8_t melody_alarm[] = {
+  NOTE(TONE_C7, 2), NOTE(TONE_E7, 2), NOTE(TONE_G7, 2), NOTE(TONE_C8, 4), NOTE(TONE_REST, 6),
+  TONE_END
+};
+
+ uint8_t melody_chime[] = {
+  NOTE(TONE_G7, 3), NOTE(TONE_C7, 6),
+  TONE_END
+};
+#endif
+
+volatile _Bool  S1_LONG;
+volatile _Bool  S1_PRESSED;
+volatile _Bool  S2_LONG;
+volatile _Bool  S2_PRESSED;
+volatile _Bool  S3_LONG;
+volatile _Bool  S3_PRESSED;
+
+volatile uint8_t debounce[3];      // switch debounce buffer
+volatile uint8_t switchcount[3];
+#define SW_CNTMAX 80
+
+// display refresh, 100us, high priority
+// only multiplexes the digits and every TICK_DIV ticks requests the 10ms tick
+// by setting CCF2: PCA module 2 has no compare/capture mode enabled, so its
+// flag is set by software only and runs tick_isr() at low priority
+#ifdef TIMER0_C_ISR
+// reference version, calls nothing, so its own register bank saves the pushes
+void timer0_isr() {
+  uint8_t digit = displaycounter % 4;
+
+  // turn off all digits, set high
+  P3 |= 0x3C;
+
+  // adc sample requested: start it now and keep this period dark
+  if (adc_start) {
+    ADC_CONTR = adc_start;
+    adc_start = 0;
+  } else
+  // auto dimming, skip lighting for some cycles
+  if (displaycounter % lightval < 4) {
+    // fill digits
+    P2 = dbuf[dbuf_front + digit];
+    // turn on selected digit, set low
+    P3 &= ~(0x4 << digit);
+  }
+  displaycounter++;
+
+  if (!--tick_div) {
+    tick_div = TICK_DIV;
+    CCF2 = 1;
+  }
+}
+#else
+// saves psw/acc/b only and borrows r0 of the interrupted bank with xch,
+// no bank switch. Straight line code, forward branches only:
+// 103 clocks worst case (STC-Y5 timing, tools/isrcycles.py run on this
+// block, which sdcc emits unchanged for a naked function), 9% of the 1105
+// clock period, checked against ISRBUDGET by make isr-cycles
+void timer0_isr() 
+{
+  mcs51_asm(
+MCS51_LINE(push	psw)
+MCS51_LINE(push	acc)
+MCS51_LINE(push	b)
+MCS51_LINE(orl	_P3,#0x3C)
+MCS51_LINE(mov	a,_adc_start)
+MCS51_LINE(jz	00005$)
+MCS51_LINE(mov	_ADC_CONTR,a)
+MCS51_LINE(mov	_adc_start,#0)
+MCS51_LINE(sjmp	00001$)
+MCS51_LINE(00005$:)
+MCS51_LINE(mov	a,_displaycounter)
+MCS51_LINE(mov	b,_lightval)
+MCS51_LINE(div	ab)
+MCS51_LINE(mov	a,b)
+MCS51_LINE(add	a,#0xFC)
+MCS51_LINE(jc	00001$)
+MCS51_LINE(mov	a,_displaycounter)
+MCS51_LINE(anl	a,#0x03)
+MCS51_LINE(mov	b,a)
+MCS51_LINE(add	a,_dbuf_front)
+MCS51_LINE(add	a,#_dbuf)
+MCS51_LINE(xch	a,r0)
+MCS51_LINE(mov	_P2,@r0)
+MCS51_LINE(xch	a,r0)
+MCS51_LINE(mov	a,#0xFB)
+MCS51_LINE(jnb	b.0,00002$)
+MCS51_LINE(rl	a)
+MCS51_LINE(00002$:)
+MCS51_LINE(jnb	b.1,00003$)
+MCS51_LINE(rl	a)
+MCS51_LINE(rl	a)
+MCS51_LINE(00003$:)
+MCS51_LINE(anl	_P3,a)
+MCS51_LINE(00001$:)
+MCS51_LINE(inc	_displaycounter)
+MCS51_LINE(djnz	_tick_div,00004$)
+MCS51_LINE(mov	_tick_div,#TICK_DIV)
+MCS51_LINE(setb	_CCF2)
+MCS51_LINE(00004$:)
+MCS51_LINE(pop	b)
+MCS51_LINE(pop	acc)
+MCS51_LINE(pop	psw)
+MCS51_LINE(reti)
+);
+}
+#endif
+
+// 10ms tick, low priority, shares the PCA interrupt with the buzzer
+// register bank 0: the callees are compiled for it and use arN (absolute
+// bank 0 addresses), from another bank they would clobber the main loop's
+// registers. Saving them costs a few us every 10ms
+void tick_isr() {
+#ifdef BUZZER
+  if (CCF0) tone_edge();
+#endif
+  if (!CCF2) return;
+  CCF2 = 0;
+
+  _10ms_count++;
+#ifdef TELEMETRY
+  if (!booted) boot_ticks++;
+#endif
+
+#ifdef CHRONO
+  // stopwatch/countdown, the expiry melody starts here, not from the loop
+  if (chrono_running() && chrono_tick()) {
+#ifdef BUZZER
+    tone_start(melody_alarm);
+#endif
+  }
+#endif
+
+  msg_tick();
+
+#ifdef GPS_UART2
+  nmea_rx_tick();
+#endif
+
+  // colon blink stuff, 500ms
+  if (_10ms_count == 50) {
+    display_colon = !display_colon;
+    _10ms_count = 0;
+  }
+
+  // switch read, debounce:
+  // increment count if settled closed
+  if ((debounce[0]) == 0x00) {
+    // down for at least 8 ticks
+    S1_PRESSED = 1;
+    switchcount[0]++;
+  } else {
+    // released or bounced, reset state            
+    S1_PRESSED = 0;
+    switchcount[0] = 0;
+  }
+
+  if ((debounce[1]) == 0x00) {
+    // down for at least 8 ticks            
+    S2_PRESSED = 1;
+    switchcount[1]++;
+  } else {
+    // released or bounced, reset state
+    S2_PRESSED = 0;
+    switchcount[1] = 0;
+  }
+
+#ifdef stc15w408as
+  if ((debounce[2]) == 0x00) {
+    // down for at least 8 ticks            
+    S3_PRESSED = 1;
+    switchcount[2]++;
+  } else {
+    // released or bounced, reset state
+    S3_PRESSED = 0;
+    switchcount[2] = 0;
+  }
+#endif
+
+  // debouncing stuff
+  // keep resetting halfway if held long
+  if (switchcount[0] > SW_CNTMAX)
+  {
+    switchcount[0] = SW_CNTMAX; S1_LONG = 1;
+  }
+  if (switchcount[1] > SW_CNTMAX)
+  {
+    switchcount[1] = SW_CNTMAX; S2_LONG = 1;
+  }
+#ifdef stc15w408as
+  if (switchcount[2] > SW_CNTMAX)
+  {
+    switchcount[2] = SW_CNTMAX; S3_LONG = 1;
+  }
+#endif
+
+  // read switch positions into sliding 8-bit window
+  debounce[0] = (debounce[0] << 1) | SW1;
+  debounce[1] = (debounce[1] << 1) | SW2;
+#ifdef stc15w408as
+  debounce[2] = (debounce[2] << 1) | SW3;
+#endif
+
+#ifdef BUZZER
+  tone_tick();
+#endif
+}
+
+void Timer0Init(void)		//100us, reload from calibrated clock
+{
+  uint16_t t0 = -cal_t0_clocks();
+  AUXR |= 0x80;   // T0 1T, reload resolution of one clock
+  TL0 = t0;		//Initial timer value
+  TH0 = t0 >> 8;		//Initial timer value
+  TF0 = 0;		//Clear TF0 flag
+  TR0 = 1;		//Timer0 start run
+  ET0 = 1;        // enable timer0 interrupt
+  PT0 = 1;        // display refresh preempts all other interrupts
+  // PCA free running, module 2 interrupt only as software 10ms tick
+  CMOD = 0x00;    // SYSclk/12, no overflow interrupt
+  CCAPM2 = 0x01;  // ECCF2
+  CR = 1;
+  EA = 1;         // global interrupt enable
+}
+
+// bank 0 as tick_isr, nmea_feed() and tm_tx_isr() are called from here
+void uart() {
+	if (RI) {
+		RI = 0;
+#ifndef GPS_UART2
+		nmea_feed(SBUF);
+#endif
+	}
+	if (TI) {
+		TI = 0; //clear TI flag
+		tm_tx_isr();
+	}
+
+}
+
+#ifdef GPS_UART2
+// S2CON is not bit addressable, S2RI/S2TI are bits 0/1
+// bank 0 as tick_isr, nmea_rx_isr() is called from here
+void uart2_isr() {
+	if (S2CON & 0x01) {
+		S2CON &= ~0x01;
+		nmea_rx_isr(S2BUF);
+	}
+	S2CON &= ~0x02;
+}
+#endif
+
+#ifdef LVD_FLUSH
+// supply dropping: display off, then config and history to battery backed
+// DS1302 RAM in one burst of command + 31 bytes. Deadline:
+//   transfer loops, measured (ds1302_test, make host-test): 4896 clocks
+//     padded, 3872 with DS_FASTIO
+//   C around them, bound: isr entry/exit with the bank 0 saves ~70, per
+//     byte call, pointer and count ~25 x 31 = 775 -> <= 850 clocks
+//     (make isr-cycles lists one pass of lvd_isr and ds_ram_writeburst on
+//     a compiled build to check it)
+//   total <= 5750 clocks padded, 4720 fast: 0.52 / 0.43ms at 11.0592MHz
+// Hold-up: dV = I * t / C. Worst case the full 30mA of lit display and
+// mcu for all of it, 30mA * 0.52ms / 100uF = 0.16V; with the digits off
+// from the first instructions the mcu alone draws a fraction of that. The
+// LVD threshold (stcgal option) has to sit more than that above the mcu
+// minimum. Once per brownout, the main loop arms it again and turns the
+// display back on when the supply is back.
+// cfg_ext and drift_acc are left out: magic, cfg_table and 25 history bytes
+// fill the 31 bytes of RAM. cfg_ext only changes from the keys and the boot
+// calibration, both log it to eeprom right away, so it is never dirty here;
+// drift_acc is below one second of correction, less than the uncompensated
+// drift while the DS1302 runs on its battery.
+// Register bank 0 like its callees: sendbyte/readbyte save r7 as ar7, the
+// bank 0 address, and are callee_saves, so a bank 1 caller would lose r7
+void lvd_isr() {
+  ds_lvd_armed = 0;
+  ELVD = 0;
+  // digits off and the display isr stopped so they stay off
+  ET0 = 0;
+  P3 |= 0x3C;
+#ifdef HISTORY
+  ds_ram_writeburst(hist_table, HIST_HOURS + 1);
+#else
+  ds_ram_writeburst(0, 0);
+#endif
+  PCON &= ~LVDF;
+}
+#endif
+
+void checkDateNeedAdjust() {
+	//to prevent need time rolling, check only if seconds between 30 and 40
+	if (rtc_table[DS_ADDR_SECONDS] > 0x30 && rtc_table[DS_ADDR_SECONDS] < 0x40) {
+		int8_t part_delta;
+		//adjust from gmt to local timezone
+		adjust_timezone();
+		
+		part_delta = (rtc_table[DS_ADDR_SECONDS] >> 4 - gpstm_table[DS_ADDR_SECONDS] >> 4) * 10 + (rtc_table[DS_ADDR_SECONDS] & 0xF - gpstm_table[DS_ADDR_SECONDS] & 0xF);
+		if (H12_24) {
+			uint8_t hours = ds_split2int(rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR24); // hours in 24h format (0-23, 0-11=>am , 12-23=>pm)
+			uint8_t b = DS_MASK_AMPM_MODE;
+			if (hours >= 12) { hours -= 12; b |= 0x20; }	// pm
+			if (hours == 0) { hours = 12; } 		//12am
+			gpstm_table[DS_ADDR_HOUR] = b | ds_int2bcd(hours);
+		}
+		if (
+			(part_delta > 2 || part_delta < -2)	//2 second difference, need adjustment
+			|| rtc_table[DS_ADDR_MINUTES] != gpstm_table[DS_ADDR_MINUTES]
+			|| rtc_table[DS_ADDR_HOUR] != gpstm_table[DS_ADDR_HOUR]
+			|| rtc_table[DS_ADDR_DAY] != gpstm_table[DS_ADDR_DAY]
+			|| rtc_table[DS_ADDR_MONTH] != gpstm_table[DS_ADDR_MONTH]
+			|| rtc_table[DS_ADDR_YEAR] != gpstm_table[DS_ADDR_YEAR]
+			) {
+
+			//update date
+			ds_writebyte(DS_ADDR_SECONDS, gpstm_table[DS_ADDR_SECONDS]);
+			ds_writebyte(DS_ADDR_MINUTES, gpstm_table[DS_ADDR_MINUTES]);
+			ds_writebyte(DS_ADDR_HOUR, gpstm_table[DS_ADDR_HOUR]);
+			ds_writebyte(DS_ADDR_DAY, gpstm_table[DS_ADDR_DAY]);
+			ds_writebyte(DS_ADDR_WEEKDAY, gpstm_table[DS_ADDR_WEEKDAY]);
+			ds_writebyte(DS_ADDR_MONTH, gpstm_table[DS_ADDR_MONTH]);
+			ds_writebyte(DS_ADDR_YEAR, gpstm_table[DS_ADDR_YEAR]);
+			msg_show("SYNC");
+
+		} else {
+			//update not needed
+		}
+		drift_reset();
+	}
+	gpstm_needupdate = 0;
+	gps_age = 0;
+
+}
+
+// keyboard actions, index into k_actions[]
+enum keyboard_action {
+  A_NONE,
+  A_HOURS_INCR,
+  A_MINUTES_INCR,
+  A_12_24_TOGGLE,
+  A_TEMP_OFFSET,
+#ifdef HISTORY
+  A_HIST_NEXT,
+  A_HIST_LEAVE,
+#endif
+  A_DATE_SWAP,
+  A_DATE_SET,
+  A_MONTH_INCR,
+  A_MONTH_DONE,
+  A_DAY_INCR,
+  A_DAY_DONE,
+  A_WEEKDAY_INCR,
+#ifdef TZ_SELECT
+  A_TZ_NEXT,
+#endif
+#if defined(TZ_SELECT) || defined(DRIFT_COMP)
+  A_CFG_EXT_DONE,
+#endif
+#ifdef DRIFT_COMP
+  A_DRIFT_FIELD_NEXT,
+  A_DRIFT_INCR,
+#endif
+#ifdef ALARM
+  A_ALARM_SWITCH,
+  A_ALARM_HOUR_INCR,
+  A_ALARM_MINUTE_INCR,
+  A_CHIME_SWITCH,
+  A_CHIME_START_INCR,
+  A_CHIME_STOP_INCR,
+#endif
+#ifdef CHRONO
+  A_STOPWATCH_START,
+  A_STOPWATCH_LAP,
+  A_COUNTDOWN_START,
+  A_COUNTDOWN_EDIT,
+  A_COUNTDOWN_MIN_INCR,
+  A_COUNTDOWN_SEC_INCR,
+  A_COUNTDOWN_SET,
+#endif
+  A_SEC_ZERO,
+  A_TIMEOUT,
+#ifdef DEBUG
+  A_DEBUG,
+#endif
+  A_S3
+};
+
+void a_temp_offset() {
+  uint8_t offset = cfg_table[CFG_TEMP_BYTE] & CFG_TEMP_MASK;
+  offset++; offset &= CFG_TEMP_MASK;
+  cfg_table[CFG_TEMP_BYTE] = (cfg_table[CFG_TEMP_BYTE] & ~CFG_TEMP_MASK) | offset;
+}
+
+#ifdef HISTORY
+void a_hist_next() { if (++hist_cursor == HIST_HOURS + 2) hist_cursor = 0; }
+void a_hist_leave() { hist_cursor = 0; }
+#endif
+
+// date is set in display order, MM/DD or DD/MM
+void a_date_swap() { CONF_SW_MMDD = !CONF_SW_MMDD; }
+void a_date_set() { kmode = CONF_SW_MMDD ? K_SET_DAY : K_SET_MONTH; }
+void a_month_done() { kmode = CONF_SW_MMDD ? K_DATE_DISP : K_SET_DAY; }
+void a_day_done() { kmode = CONF_SW_MMDD ? K_SET_MONTH : K_DATE_DISP; }
+
+#if defined(TZ_SELECT) || defined(DRIFT_COMP)
+// leaving a cfg_ext screen: with LVD_FLUSH only cfg_table reaches DS1302 RAM
+// on power loss, cfg_ext is logged to eeprom right away
+void a_cfg_ext_done() {
+#ifdef LVD_FLUSH
+  ee_config_save();
+#endif
+}
+#endif
+
+#ifdef ALARM
+void a_alarm_switch() { CONF_ALARM_ON = !CONF_ALARM_ON; alarm_reschedule(); }
+void a_chime_switch() { CONF_CHIME_ON = !CONF_CHIME_ON; alarm_reschedule(); }
+#endif
+
+void a_timeout() { if (count > 100) kmode = K_NORMAL; }
+#ifdef DEBUG
+void a_debug() {
+  if (count > 100) kmode = K_NORMAL;
+  if (S1_PRESSED || S2_PRESSED) count = 0;
+}
+#endif
+
+void a_s3() {
+#ifdef stc15w408as
+  if (!S3_PRESSED) {
+    if (S3_LONG) { S3_LONG = 0; LED = !LED; }
+  }
+#endif
+}
+
+typedef void (*k_action_t)();
+
+ k_action_t k_actions[] = {
+  0,
+  ds_hours_incr,
+  ds_minutes_incr,
+  ds_hours_12_24_toggle,
+  a_temp_offset,
+#ifdef HISTORY
+  a_hist_next,
+  a_hist_leave,
+#endif
+  a_date_swap,
+  a_date_set,
+  ds_month_incr,
+  a_month_done,
+  ds_day_incr,
+  a_day_done,
+  ds_weekday_incr,
+#ifdef TZ_SELECT
+  tz_select_next,
+#endif
+#if defined(TZ_SELECT) || defined(DRIFT_COMP)
+  a_cfg_ext_done,
+#endif
+#ifdef DRIFT_COMP
+  drift_field_next,
+  drift_value_incr,
+#endif
+#ifdef ALARM
+  a_alarm_switch,
+  alarm_hour_incr,
+  alarm_minute_incr,
+  a_chime_switch,
+  chime_start_incr,
+  chime_stop_incr,
+#endif
+#ifdef CHRONO
+  chrono_up_start,
+  chrono_up_lap,
+  chrono_down_start,
+  chrono_down_edit,
+  chrono_down_min_incr,
+  chrono_down_sec_incr,
+  chrono_down_set,
+#endif
+  ds_sec_zero,
+  a_timeout,
+#ifdef DEBUG
+  a_debug,
+#endif
+  a_s3
+};
+
+// keyboard state: display mode, flashing digits, action run every loop and
+// per event next state and action (action runs after the transition)
+// S1 waits for release when E_S1_LONG is handled, otherwise it repeats
+// keys are ignored while the flashed digits are off
+// Against the kmode switch it replaced: the tables are 9 bytes a state and
+// 2 an action, 120 bytes on the stc15f204ea defaults (10 states, 15
+// actions), 284 on the stc15w408as (24, 34). Not yet measured on compiled
+// code, hand estimates: the switch took ~25 bytes a state with its jump
+// table, plus 3-5 one-shot/wait states the table does not need, about even
+// on the stc15f204ea, ~180 bytes less for the table with the 408AS features;
+// k_dispatch() ~105 clocks a loop pass without a key against ~50 for the
+// switch. make isr-cycles prints the one pass count of _k_dispatch, the
+// code total is in main.mem / make size-report
+typedef struct {
+  uint8_t dmode;
+  uint8_t flash;
+  uint8_t tick;
+  uint8_t next[E_COUNT];
+  uint8_t action[E_COUNT];
+} kstate_t;
+
+ kstate_t kstates[K_COUNT] = {
+  //                  dmode             flash   tick       S1 / S1 long / S2 next                     S1 / S1 long / S2 action
+  /* K_NORMAL */        { M_NORMAL,         F_NONE, A_S3,      { K_SEC_DISP, K_SET_HOUR, K_TEMP_DISP },   { A_NONE, A_NONE, A_NONE } },
+  /* K_SET_HOUR */      { M_NORMAL,         F_01,   A_NONE,    { K_SET_MINUTE, K_STAY, K_STAY },          { A_NONE, A_NONE, A_HOURS_INCR } },
+  /* K_SET_MINUTE */    { M_NORMAL,         F_23,   A_NONE,    { K_SET_HOUR_12_24, K_STAY, K_STAY },      { A_NONE, A_NONE, A_MINUTES_INCR } },
+  /* K_SET_HOUR_12_24 */{ M_SET_HOUR_12_24, F_NONE, A_NONE,    { K_NORMAL, K_STAY, K_STAY },              { A_NONE, A_NONE, A_12_24_TOGGLE } },
+  /* K_SEC_DISP */      { M_SEC_DISP,       F_NONE, A_TIMEOUT, { K_NORMAL, K_STAY, K_STAY },              { A_NONE, A_NONE, A_SEC_ZERO } },
+  /* K_TEMP_DISP */     { M_TEMP_DISP,      F_NONE, A_NONE,    { K_STAY, K_STAY, K_HIST_GROUP },          { A_TEMP_OFFSET, A_NONE, A_NONE } },
+#ifdef HISTORY
+  /* K_HIST_DISP */     { M_HIST_DISP,      F_NONE, A_NONE,    { K_STAY, K_STAY, K_DATE_DISP },           { A_HIST_NEXT, A_NONE, A_HIST_LEAVE } },
+#endif
+  /* K_DATE_DISP */     { M_DATE_DISP,      F_NONE, A_NONE,    { K_STAY, K_STAY, K_WEEKDAY_DISP },        { A_DATE_SWAP, A_DATE_SET, A_NONE } },
+  /* K_SET_MONTH */     { M_DATE_DISP,      F_01,   A_NONE,    { K_STAY, K_STAY, K_STAY },                { A_MONTH_DONE, A_NONE, A_MONTH_INCR } },
+  /* K_SET_DAY */       { M_DATE_DISP,      F_23,   A_NONE,    { K_STAY, K_STAY, K_STAY },                { A_DAY_DONE, A_NONE, A_DAY_INCR } },
+  /* K_WEEKDAY_DISP */  { M_WEEKDAY_DISP,   F_NONE, A_NONE,    { K_STAY, K_STAY, K_TZ_GROUP },            { A_WEEKDAY_INCR, A_NONE, A_NONE } },
+#ifdef TZ_SELECT
+  /* K_TZ_DISP */       { M_TZ_DISP,        F_NONE, A_NONE,    { K_STAY, K_STAY, K_DRIFT_GROUP },         { A_TZ_NEXT, A_NONE, A_CFG_EXT_DONE } },
+#endif
+#ifdef DRIFT_COMP
+  /* K_DRIFT_DISP */    { M_DRIFT_DISP,     F_NONE, A_NONE,    { K_STAY, K_SET_DRIFT, K_ALARM_GROUP },    { A_DRIFT_FIELD_NEXT, A_NONE, A_NONE } },
+  /* K_SET_DRIFT */     { M_DRIFT_DISP,     F_23,   A_NONE,    { K_DRIFT_DISP, K_STAY, K_STAY },          { A_CFG_EXT_DONE, A_NONE, A_DRIFT_INCR } },
+#endif
+#ifdef ALARM
+  /* K_ALARM_DISP */    { M_ALARM_DISP,     F_NONE, A_NONE,    { K_STAY, K_SET_ALARM_HOUR, K_CHIME_DISP },{ A_ALARM_SWITCH, A_NONE, A_NONE } },
+  /* K_SET_ALARM_HOUR */{ M_ALARM_DISP,     F_01,   A_NONE,    { K_SET_ALARM_MINUTE, K_STAY, K_STAY },    { A_NONE, A_NONE, A_ALARM_HOUR_INCR } },
+  /* K_SET_ALARM_MINUTE */{ M_ALARM_DISP,   F_23,   A_NONE,    { K_ALARM_DISP, K_STAY, K_STAY },          { A_NONE, A_NONE, A_ALARM_MINUTE_INCR } },
+  /* K_CHIME_DISP */    { M_CHIME_DISP,     F_NONE, A_NONE,    { K_STAY, K_SET_CHIME_START, K_CHRONO_GROUP },{ A_CHIME_SWITCH, A_NONE, A_NONE } },
+  /* K_SET_CHIME_START */{ M_CHIME_DISP,    F_01,   A_NONE,    { K_SET_CHIME_STOP, K_STAY, K_STAY },      { A_NONE, A_NONE, A_CHIME_START_INCR } },
+  /* K_SET_CHIME_STOP */{ M_CHIME_DISP,     F_23,   A_NONE,    { K_CHIME_DISP, K_STAY, K_STAY },          { A_NONE, A_NONE, A_CHIME_STOP_INCR } },
+#endif
+#ifdef CHRONO
+  /* K_STOPWATCH */     { M_STOPWATCH,      F_NONE, A_NONE,    { K_STAY, K_STAY, K_COUNTDOWN },           { A_STOPWATCH_START, A_STOPWATCH_LAP, A_NONE } },
+  /* K_COUNTDOWN */     { M_COUNTDOWN,      F_NONE, A_NONE,    { K_STAY, K_SET_COUNTDOWN_MIN, K_NORMAL }, { A_COUNTDOWN_START, A_COUNTDOWN_EDIT, A_NONE } },
+  /* K_SET_COUNTDOWN_MIN */{ M_COUNTDOWN,   F_01,   A_NONE,    { K_SET_COUNTDOWN_SEC, K_STAY, K_STAY },   { A_NONE, A_NONE, A_COUNTDOWN_MIN_INCR } },
+  /* K_SET_COUNTDOWN_SEC */{ M_COUNTDOWN,   F_23,   A_NONE,    { K_COUNTDOWN, K_STAY, K_STAY },           { A_COUNTDOWN_SET, A_NONE, A_COUNTDOWN_SEC_INCR } },
+#endif
+#ifdef DEBUG
+  /* K_DEBUG */         { M_DEBUG,          F_NONE, A_DEBUG,   { K_STAY, K_STAY, K_STAY },                { A_NONE, A_NONE, A_NONE } },
+#endif
+};
+
+// keyboard state machine, once a loop pass
+void k_dispatch() {
+   kstate_t *ks = &kstates[kmode];
+  uint8_t ev = E_NONE;
+  _Bool hold = 0;
+
+  dmode = ks->dmode;
+  if (ks->flash == F_01) {
+    flash_01 = !flash_01; flash_23 = 0; hold = flash_01;
+  } else if (ks->flash == F_23) {
+    flash_23 = !flash_23; flash_01 = 0; hold = flash_23;
+  } else {
+    flash_01 = 0; flash_23 = 0;
+  }
+
+  if (kwait) {
+    count = 0;
+    if (!S1_PRESSED) {
+      kwait = 0;
+      if (S1_LONG) { S1_LONG = 0; ev = E_S1_LONG; } else { ev = E_S1; }
+    }
+  } else if (!hold) {
+    if (S1_PRESSED) {
+      if (ks->next[E_S1_LONG] != K_STAY || ks->action[E_S1_LONG] != A_NONE) kwait = 1; else ev = E_S1;
+    } else if (S2_PRESSED) {
+      ev = E_S2;
+    }
+  }
+
+  if (ks->tick) k_actions[ks->tick]();
+  if (ev != E_NONE) {
+    if (ks->next[ev] != K_STAY) kmode = ks->next[ev];
+    if (ks->action[ev]) k_actions[ks->action[ev]]();
+  }
+}
+
+void update_temp(){
+	uint16_t newtemp = getADCResult(ADC_TEMP);
+	//adjust temperature
+	newtemp = 76 - newtemp * 64 / 637;
+  temp = newtemp + (cfg_table[CFG_TEMP_BYTE] & CFG_TEMP_MASK) - 4;
+	
+}
+
+#ifdef LIGHT_STATS
+#ifndef TELEMETRY
+#error "LIGHT_STATS reports on telemetry, enable TELEMETRY too"
+#endif
+// light sensor noise, variance of LIGHT_STAT_N samples in 1/16 LSB^2 on
+// telemetry, compare with an ADC_FREERUN build. Measurement only: 32 bit
+// math and a report that waits while the telemetry queue is full
+#define LIGHT_STAT_N 16
+uint8_t  light_n;
+uint16_t light_sum;
+uint32_t light_sumsq;
+#endif
+
+void update_lightval(){
+	uint8_t sample = getADCResult8(ADC_LIGHT);
+	uint16_t new_lightval = sample << 8;
+
+#ifdef LIGHT_STATS
+	light_sum += sample;
+	light_sumsq += (uint16_t)sample * sample;
+	if (++light_n == LIGHT_STAT_N) {
+		uint32_t var = light_sumsq - (uint32_t)light_sum * light_sum / LIGHT_STAT_N;
+		tm_report("lvar", var > 0x7FFF ? 0x7FFF : var);
+		light_n = 0;
+		light_sum = 0;
+		light_sumsq = 0;
+	}
+#endif
+
+	if(new_lightval > raw_lightval){
+		//dim instantly
+		raw_lightval = new_lightval;
+	}else{
+		//slowly increase light
+		raw_lightval -= raw_lightval >> 2;
+		raw_lightval += new_lightval >> 2;
+	};
+	
+	if (raw_lightval <= 32 * 256) {
+		lightval = 4;
+	} else if (raw_lightval <= 128 * 256) {
+		//div by 8
+		lightval = raw_lightval >> 11;
+	} else {
+		//adjust
+		lightval = (raw_lightval >> 8) - 112;
+	}
+
+}
+
+/*********************************************/
+int main()
+{
+  // SETUP
+  // set photoresistor & ntc pins to open-drain output
+  P1M1 |= (1 << 6) | (1 << 7);
+  P1M0 |= (1 << 6) | (1 << 7);
+
+  // init rtc, rtc_table is valid from here
+  ds_init();
+  // read config from eeprom log (DS1302 RAM on first boot)
+  ee_config_init();
+
+  // display first, boot glyph until the first frame of the loop, refresh
+  // from the stored calibration (nominal clock when there is none)
+  clearTmpDisplay();
+  filldisplay(0, LED_DASH, 0);
+  filldisplay(1, LED_DASH, 0);
+  filldisplay(2, LED_DASH, 0);
+  filldisplay(3, LED_DASH, 0);
+  updateTmpDisplay();
+  Timer0Init(); // display refresh & switch read
+
+#ifdef RC_CAL
+  // RC oscillator calibration: once, or again when S1+S2 are held at power on.
+  // Takes 2-3s with the dashes up; takes over the PCA counter, Timer0Init()
+  // starts it again and reloads T0 from the result
+  if (!cal_get() || (!SW1 && !SW2)) {
+    uint16_t clock = cal_measure();
+    if (clock) cal_set(clock);
+    Timer0Init();
+  }
+#endif
+
+#ifdef LVD_FLUSH
+  // config is only written on power loss, take over what was flushed to
+  // DS1302 RAM and log it in eeprom now while the supply is good
+  ds_ram_config_init();
+  ee_config_save();
+#endif
+
+  //set UART pins @ 3.6 & 3.7
+  P_SW1 = P_SW1 & ~0xC0 | 0x40;
+  //no parity
+  SCON = 0x50;
+  //Set port speed
+  {
+    uint16_t t2 = -cal_t2_clocks();
+    T2L = t2;
+    T2H = t2 >> 8;
+  }
+  //
+  AUXR |= 0x15;  // T2 1T, start, UART1 baud from T2; keeps T0 1T from Timer0Init
+  //enable interrupt
+  ES = 1;
+#ifdef GPS_UART2
+  // UART2 @ P1.0/P1.1, 8 bit, receive, baud rate from T2 as UART1
+  P_SW2 &= ~0x01;
+  S2CON = 0x10;
+  IE2 |= 0x01;    // ES2
+#endif
+  // load temperature history, needs current hour
+  hist_init();
+
+  // uncomment in order to reset minutes and hours to zero.. Should not need this.
+  //ds_reset_clock();    
+
+#ifdef LVD_FLUSH
+  PCON &= ~LVDF;  // set at power on
+  ds_lvd_armed = 1;
+  ELVD = 1;
+#endif
+
+  // LOOP
+  // first pass runs right away, sensors sampled and time shown before the
+  // loop delay and the deferred setup below
+  while (1)
+  {
+
+    // sample adc, run frequently
+    if ((count % 4) == 0) {
+			//update temperature value
+      update_temp();
+      hist_update(temp);
+
+      // auto-dimming
+			update_lightval();
+    }
+
+    ds_readburst(); // read rtc
+    drift_apply();
+		if (gpstm_needupdate == 1) {
+			checkDateNeedAdjust();
+		}
+    // gps watchdog, counts minutes without gps time
+    if (rtc_table[DS_ADDR_MINUTES] != gps_minute) {
+      gps_minute = rtc_table[DS_ADDR_MINUTES];
+      drift_minute(temp);
+#ifdef GPS_CONFIG
+      gps_report();
+#endif
+      if (gps_age != GPS_NEVER && ++gps_age == GPS_LOST) msg_show("GPS LOST");
+    }
+
+    // alarm/chime, evaluated once per minute rollover
+    switch (alarm_check()) {
+    case ALARM_ALARM:
+      ring = RING_ALARM;
+      msg_show("ALARM");
+      break;
+    case ALARM_CHIME:
+#ifdef BUZZER
+      if (!ring) tone_play(melody_chime);
+#endif
+      break;
+    }
+#ifdef BUZZER
+    // any key silences the buzzer
+    if (S1_PRESSED || S2_PRESSED) { ring = 0; tone_stop(); }
+    // melodies are played by the PCA, loop only restarts the alarm melody
+    if (ring && !tone_busy()) tone_play(melody_alarm);
+#endif
+    if (ring) ring--;
+
+#ifdef CHRONO
+    // countdown expired, the tick isr started the melody already
+    if (chrono_expired) {
+      chrono_expired = 0;
+      ring = RING_ALARM;
+      msg_show("TIME");
+    }
+#endif
+
+    // keyboard state machine, see kstates[]
+    k_dispatch();
+
+    // display execution tree
+
+    clearTmpDisplay();
+
+    // queued messages take over the display until shown
+    if (!msg_render(tmpbuf))
+    switch (dmode) {
+    case M_NORMAL:
+      if (flash_01) {
+        dotdisplay(1, display_colon);
+      } else {
+        if (!H12_24) {
+          filldisplay(0, (rtc_table[DS_ADDR_HOUR] >> 4)&(DS_MASK_HOUR24_TENS >> 4), 0);	// tenhour 
+        } else {
+          if (H12_TH) filldisplay(0, 1, 0);	// tenhour in case AMPM mode is on, then '1' only is H12_TH is on
+        }
+        filldisplay(1, rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR_UNITS, display_colon);
+      }
+
+      if (flash_23) {
+        dotdisplay(2, display_colon);
+        dotdisplay(3, H12_24&H12_PM);	// dot3 if AMPM mode and PM=1
+      } else {
+        filldisplay(2, (rtc_table[DS_ADDR_MINUTES] >> 4)&(DS_MASK_MINUTES_TENS >> 4), display_colon);	//tenmin
+        filldisplay(3, rtc_table[DS_ADDR_MINUTES] & DS_MASK_MINUTES_UNITS, H12_24 & H12_PM);  		//min
+      }
+      break;
+
+    case M_SET_HOUR_12_24:
+      if (!H12_24) {
+        filldisplay(1, 2, 0); filldisplay(2, 4, 0);
+      } else {
+        filldisplay(1, 1, 0); filldisplay(2, 2, 0);
+      }
+      filldisplay(3, LED_h, 0);
+      break;
+
+    case M_SEC_DISP:
+      dotdisplay(0, display_colon);
+      dotdisplay(1, display_colon);
+      filldisplay(2, (rtc_table[DS_ADDR_SECONDS] >> 4)&(DS_MASK_SECONDS_TENS >> 4), 0);
+      filldisplay(3, rtc_table[DS_ADDR_SECONDS] & DS_MASK_SECONDS_UNITS, 0);
+      break;
+
+    case M_DATE_DISP:
+      if (flash_01) {
+        dotdisplay(1, 1);
+      } else {
+        if (!CONF_SW_MMDD) {
+          filldisplay(0, rtc_table[DS_ADDR_MONTH] >> 4, 0);	// tenmonth ( &MASK_TENS useless, as MSB bits are read as '0')
+          filldisplay(1, rtc_table[DS_ADDR_MONTH] & DS_MASK_MONTH_UNITS, 1);
+        } else {
+          filldisplay(2, rtc_table[DS_ADDR_MONTH] >> 4, 0);	// tenmonth ( &MASK_TENS useless, as MSB bits are read as '0')
+          filldisplay(3, rtc_table[DS_ADDR_MONTH] & DS_MASK_MONTH_UNITS, 0);
+        }
+      }
+      if (!flash_23) {
+        if (!CONF_SW_MMDD) {
+          filldisplay(2, rtc_table[DS_ADDR_DAY] >> 4, 0);		      // tenday   ( &MASK_TENS useless)
+          filldisplay(3, rtc_table[DS_ADDR_DAY] & DS_MASK_DAY_UNITS, 0);
+        }     // day       
+        else {
+          filldisplay(0, rtc_table[DS_ADDR_DAY] >> 4, 0);		      // tenday   ( &MASK_TENS useless)
+          filldisplay(1, rtc_table[DS_ADDR_DAY] & DS_MASK_DAY_UNITS, 1);
+        }     // day       
+      }
+      break;
+
+    case M_WEEKDAY_DISP:
+      filldisplay(1, LED_DASH, 0);
+      filldisplay(2, rtc_table[DS_ADDR_WEEKDAY], 0);		//weekday ( &MASK_UNITS useless, all MSBs are '0')
+      filldisplay(3, LED_DASH, 0);
+      break;
+
+#ifdef TZ_SELECT
+    case M_TZ_DISP:
+      // 't', standard offset in hours, dot3 when the rule has dst
+      {
+        int8_t h = (int8_t)cfg_ext[CFG_EXT_TZ + TZ_OFFSET] / 4;
+        filldisplay(0, LED_t, 0);
+        if (h < 0) {
+          filldisplay(1, LED_DASH, 0);
+          h = -h;
+        }
+        if (h >= 10) filldisplay(2, ds_int2bcd_tens(h), 0);
+        filldisplay(3, ds_int2bcd_ones(h), cfg_ext[CFG_EXT_TZ + TZ_DST] != 0);
+      }
+      break;
+#endif
+
+#ifdef DRIFT_COMP
+    case M_DRIFT_DISP:
+      // 'c' turnover C, 'k' 0.001ppm/C^2, 'a' aging 0.1ppm
+      {
+        int8_t v = drift_value();
+        filldisplay(0, drift_field == DRIFT_F_T0 ? LED_c : drift_field == DRIFT_F_K ? LED_k : LED_a, 0);
+        if (v < 0) {
+          filldisplay(1, LED_DASH, 0);
+          v = -v;
+        }
+        if (!flash_23) {
+          filldisplay(2, ds_int2bcd_tens(v), 0);
+          filldisplay(3, ds_int2bcd_ones(v), 0);
+        }
+      }
+      break;
+#endif
+
+#ifdef ALARM
+    case M_ALARM_DISP:
+      // alarm time, dot3 when alarm is on
+      if (!flash_01) {
+        filldisplay(0, ds_int2bcd_tens(cfg_table[CFG_ALARM_HOURS_BYTE] >> 3), 0);
+        filldisplay(1, ds_int2bcd_ones(cfg_table[CFG_ALARM_HOURS_BYTE] >> 3), 1);
+      }
+      if (!flash_23) {
+        filldisplay(2, ds_int2bcd_tens(cfg_table[CFG_ALARM_MINUTES_BYTE] & CFG_ALARM_MINUTES_MASK), 1);
+        filldisplay(3, ds_int2bcd_ones(cfg_table[CFG_ALARM_MINUTES_BYTE] & CFG_ALARM_MINUTES_MASK), CONF_ALARM_ON);
+      }
+      break;
+
+    case M_CHIME_DISP:
+      // chime start hour . stop hour, dot3 when chime is on
+      if (!flash_01) {
+        filldisplay(0, ds_int2bcd_tens(cfg_table[CFG_CHIME_START_BYTE] >> 3), 0);
+        filldisplay(1, ds_int2bcd_ones(cfg_table[CFG_CHIME_START_BYTE] >> 3), 1);
+      }
+      if (!flash_23) {
+        filldisplay(2, ds_int2bcd_tens(cfg_table[CFG_CHIME_STOP_BYTE] & CFG_CHIME_STOP_MASK), 0);
+        filldisplay(3, ds_int2bcd_ones(cfg_table[CFG_CHIME_STOP_BYTE] & CFG_CHIME_STOP_MASK), CONF_CHIME_ON);
+      }
+      break;
+#endif
+
+    case M_TEMP_DISP:
+      filldisplay(0, ds_int2bcd_tens(temp), 0);
+      filldisplay(1, ds_int2bcd_ones(temp), 0);
+      filldisplay(2, CONF_C_F ? LED_f : LED_c, 1);
+      // if (temp<0) filldisplay( 3, LED_DASH, 0);  -- temp defined as uint16, cannot be <0
+      break;
+
+#ifdef HISTORY
+    case M_HIST_DISP:
+      {
+        uint8_t s;
+        if (hist_cursor < 2) {
+          // daily min 'Lo' / max 'Hi'
+          filldisplay(0, hist_cursor ? LED_H : LED_L, 0);
+          filldisplay(1, hist_cursor ? LED_i : LED_o, 0);
+          s = hist_cursor ? hist_max : hist_min;
+        } else {
+          // hour of sample, newest first
+          uint8_t h = hist_table[HIST_INDEX] + HIST_HOURS - (hist_cursor - 2);
+          if (h >= HIST_HOURS) h -= HIST_HOURS;
+          filldisplay(0, ds_int2bcd_tens(h), 0);
+          filldisplay(1, ds_int2bcd_ones(h), 1);
+          s = hist_sample(hist_cursor - 2);
+        }
+        if (s == HIST_EMPTY) {
+          filldisplay(2, LED_DASH, 0);
+          filldisplay(3, LED_DASH, 0);
+        } else if (s < HIST_TEMP_OFFSET) {
+          // below zero, one digit only
+          filldisplay(2, LED_DASH, 0);
+          filldisplay(3, ds_int2bcd_ones(HIST_TEMP_OFFSET - s), 0);
+        } else {
+          filldisplay(2, ds_int2bcd_tens(s - HIST_TEMP_OFFSET), 0);
+          filldisplay(3, ds_int2bcd_ones(s - HIST_TEMP_OFFSET), 0);
+        }
+      }
+      break;
+#endif
+
+#ifdef CHRONO
+    case M_STOPWATCH:
+    case M_COUNTDOWN:
+      {
+        uint8_t t[3];
+        // colon blinks while running, dp3 marks a frozen lap
+        _Bool colon = (dmode == M_STOPWATCH ? chrono_up_run : chrono_down_run) ? display_colon : 1;
+        chrono_read(t, dmode == M_COUNTDOWN);
+        if (dmode == M_STOPWATCH && !t[CHRONO_MIN]) {
+          // first minute as SS.hh
+          filldisplay(0, t[CHRONO_SEC] >> 4, 0);
+          filldisplay(1, t[CHRONO_SEC] & 0x0F, 1);
+          filldisplay(2, t[CHRONO_HSEC] >> 4, 0);
+          filldisplay(3, t[CHRONO_HSEC] & 0x0F, chrono_lap_on);
+          break;
+        }
+        // MM:SS
+        if (!flash_01) {
+          filldisplay(0, t[CHRONO_MIN] >> 4, 0);
+          filldisplay(1, t[CHRONO_MIN] & 0x0F, colon);
+        }
+        if (!flash_23) {
+          filldisplay(2, t[CHRONO_SEC] >> 4, colon);
+          filldisplay(3, t[CHRONO_SEC] & 0x0F, chrono_lap_on && dmode == M_STOPWATCH);
+        }
+      }
+      break;
+#endif
+
+#ifdef DEBUG
+    case M_DEBUG:
+      filldisplay(0, switchcount[0] >> 4, S1_LONG);
+      filldisplay(1, switchcount[0] & 15, S1_PRESSED);
+      filldisplay(2, switchcount[1] >> 4, S2_LONG);
+      filldisplay(3, switchcount[1] & 15, S2_PRESSED);
+      break;
+#endif
+    }
+
+    // render and publish frame, only flips buffers when it changed
+    updateTmpDisplay();
+
+#ifdef LVD_FLUSH
+    // after a flush: arm again once LVDF stays clear for a loop
+    if (!ds_lvd_armed) {
+      if (PCON & LVDF) {
+        PCON &= ~LVDF;
+      } else {
+        ds_lvd_armed = 1;
+        ELVD = 1;
+        ET0 = 1;
+      }
+    }
+#else
+    // save config, only written when changed
+    ee_config_save();
+#endif
+
+    // deferred setup, the first frame is up by now
+    if (!booted) {
+#ifdef TELEMETRY
+      // power on to first valid time in ms, counted from Timer0Init; ds_init
+      // and ee_config_init before it are well below 1ms. A tick requested
+      // but not yet run (CCF2) is added
+      uint16_t ms;
+      EA = 0;
+      ms = boot_ticks * 10 + (TICK_DIV - tick_div) / 10;
+      if (CCF2) ms += 10;
+      booted = 1;
+      EA = 1;
+      tm_report("boot", ms);
+#else
+      booted = 1;
+#endif
+#ifdef RC_CAL
+      tm_report("cal", cal_error());
+#endif
+#ifdef GPS_CONFIG
+      gps_configure();   // blocks while ~90 bytes drain at 9600 baud
+#endif
+    }
+
+    if (S1_PRESSED || S2_PRESSED && !(S1_LONG || S2_LONG)) {
+      // try to dampen button over-response
+      _delay_ms(100);
+    }
+
+    // reset long presses when button released
+    if (!S1_PRESSED && S1_LONG) {
+      S1_LONG = 0;
+    }
+    if (!S2_PRESSED && S2_LONG) {
+      S2_LONG = 0;
+    }
+
+    count++;
+    WDT_CLEAR();
+
+    //RELAY = 0;
+    _delay_ms(100);
+    //RELAY = 1;
+  }
+}
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,34 @@
+// NMEA receiver, picks GPS time/date from $GPZDA sentences
+// no sfr access, the parser only works on its own state and gpstm_table
+//
+
+#include <stdint.h>
+
+// last ZDA time/date, BCD in DS1302 register order (DS_ADDR_x), UTC
+extern volatile uint8_t gpstm_table[8];
+// set when gpstm_table holds a checksum verified sentence, input is ignored
+// until the main loop clears it
+extern volatile _Bool gpstm_needupdate;
+
+#ifdef GPS_CONFIG
+// receive counters, read and cleared once a minute by gps_report()
+extern volatile uint16_t nmea_bytes;
+extern volatile uint16_t nmea_sentences;
+extern volatile uint16_t nmea_zda;
+#endif
+
+// feed one received character
+void nmea_feed(uint8_t data);
+
+#ifdef GPS_UART2
+// UART2 receive queue, filled by the uart2 isr and parsed from the 10ms tick,
+// keeps the receive isr a few instructions long. 16 bytes hold 16ms @ 9600
+// baud, characters arriving on a full queue are dropped (checksum fails)
+#define NMEA_RXQ  16
+
+// uart2 isr, queue one received character
+void nmea_rx_isr(uint8_t c);
+
+// tick isr, parse the queued characters
+void nmea_rx_tick();
+#endif
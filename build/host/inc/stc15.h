@@ -0,0 +1,288 @@
+#ifndef _STC15_H_
+#define _STC15_H_
+
+#include <8051.h>
+
+#ifdef REG8051_H
+#undef REG8051_H
+#endif
+
+/*  P4  */
+#define P4 mcs51_sfr[0xC0]
+#define _P4 0xC0
+#define P4_0 mcs51_bit(0xC0)
+#define _P4_0 0xC0
+#define P4_1 mcs51_bit(0xC1)
+#define _P4_1 0xC1
+#define P4_2 mcs51_bit(0xC2)
+#define _P4_2 0xC2
+#define P4_3 mcs51_bit(0xC3)
+#define _P4_3 0xC3
+#define P4_4 mcs51_bit(0xC4)
+#define _P4_4 0xC4
+#define P4_5 mcs51_bit(0xC5)
+#define _P4_5 0xC5
+#define P4_6 mcs51_bit(0xC6)
+#define _P4_6 0xC6
+#define P4_7 mcs51_bit(0xC7)
+#define _P4_7 0xC7
+
+/*  P5  */
+#define P5 mcs51_sfr[0xC8]
+#define _P5 0xC8
+#define P5_4 mcs51_bit(0xCC)
+#define _P5_4 0xCC
+#define P5_5 mcs51_bit(0xCD)
+#define _P5_5 0xCD
+
+#define P0M0 mcs51_sfr[0x94]
+#define _P0M0 0x94
+#define P0M1 mcs51_sfr[0x93]
+#define _P0M1 0x93
+#define P1M0 mcs51_sfr[0x92]
+#define _P1M0 0x92 
+#define P1M1 mcs51_sfr[0x91]
+#define _P1M1 0x91 
+#define P2M0 mcs51_sfr[0x96]
+#define _P2M0 0x96
+#define P2M1 mcs51_sfr[0x95]
+#define _P2M1 0x95
+#define P3M0 mcs51_sfr[0xB2]
+#define _P3M0 0xB2
+#define P3M1 mcs51_sfr[0xB1]
+#define _P3M1 0xB1
+#define P4M0 mcs51_sfr[0xB4]
+#define _P4M0 0xB4
+#define P4M1 mcs51_sfr[0xB3]
+#define _P4M1 0xB3
+#define P5M0 mcs51_sfr[0xCA]
+#define _P5M0 0xCA
+#define P5M1 mcs51_sfr[0xC9]
+#define _P5M1 0xC9
+#define P6M0 mcs51_sfr[0xCC]
+#define _P6M0 0xCC
+#define P6M1 mcs51_sfr[0xCB]
+#define _P6M1 0xCB
+#define P7M0 mcs51_sfr[0xE2]
+#define _P7M0 0xE2
+#define P7M1 mcs51_sfr[0xE1]
+#define _P7M1 0xE1
+
+#define AUXR mcs51_sfr[0x8E]
+#define _AUXR 0x8E 
+#define AUXR1 mcs51_sfr[0xA2]
+#define _AUXR1 0xA2
+#define P_SW1 mcs51_sfr[0xA2]
+#define _P_SW1 0xA2
+#define CLK_DIV mcs51_sfr[0x97]
+#define _CLK_DIV 0x97
+#define BUS_SPEED mcs51_sfr[0xA1]
+#define _BUS_SPEED 0xA1
+#define P1ASF mcs51_sfr[0x9D]
+#define _P1ASF 0x9D
+#define P_SW2 mcs51_sfr[0xBA]
+#define _P_SW2 0xBA
+
+/*  PCON  */
+#define LVDF        0x20    // low voltage flag, also set at power on
+
+/*  IE  */
+#define ELVD mcs51_bit(0xAE)
+#define _ELVD 0xAE
+#define EADC mcs51_bit(0xAD)
+#define _EADC 0xAD
+
+/*  IP  */
+#define PPCA mcs51_bit(0xBF)
+#define _PPCA 0xBF
+#define PLVD mcs51_bit(0xBE)
+#define _PLVD 0xBE
+#define PADC mcs51_bit(0xBD)
+#define _PADC 0xBD
+
+#define IE2 mcs51_sfr[0xAF]
+#define _IE2 0xAF
+#define IP2 mcs51_sfr[0xB5]
+#define _IP2 0xB5
+#define INT_CLKO mcs51_sfr[0x8F]
+#define _INT_CLKO 0x8F
+
+#define T4T3M mcs51_sfr[0xD1]
+#define _T4T3M 0xD1
+#define T3T4M mcs51_sfr[0xD1]
+#define _T3T4M 0xD1
+#define T4H mcs51_sfr[0xD2]
+#define _T4H 0xD2
+#define T4L mcs51_sfr[0xD3]
+#define _T4L 0xD3
+#define T3H mcs51_sfr[0xD4]
+#define _T3H 0xD4
+#define T3L mcs51_sfr[0xD5]
+#define _T3L 0xD5
+#define T2H mcs51_sfr[0xD6]
+#define _T2H 0xD6
+#define T2L mcs51_sfr[0xD7]
+#define _T2L 0xD7
+#define WKTCL mcs51_sfr[0xAA]
+#define _WKTCL 0xAA
+#define WKTCH mcs51_sfr[0xAB]
+#define _WKTCH 0xAB
+#define WDT_CONTR mcs51_sfr[0xC1]
+#define _WDT_CONTR 0xC1
+
+#define S2CON mcs51_sfr[0x9A]
+#define _S2CON 0x9A
+#define S2BUF mcs51_sfr[0x9B]
+#define _S2BUF 0x9B
+#define S3CON mcs51_sfr[0xAC]
+#define _S3CON 0xAC
+#define S3BUF mcs51_sfr[0xAD]
+#define _S3BUF 0xAD
+#define S4CON mcs51_sfr[0x84]
+#define _S4CON 0x84
+#define S4BUF mcs51_sfr[0x85]
+#define _S4BUF 0x85
+#define SADDR mcs51_sfr[0xA9]
+#define _SADDR 0xA9
+#define SADEN mcs51_sfr[0xB9]
+#define _SADEN 0xB9
+
+//ADC
+#define ADC_CONTR mcs51_sfr[0xBC]
+#define _ADC_CONTR 0xBC 
+#define ADC_RES mcs51_sfr[0xBD]
+#define _ADC_RES 0xBD
+#define ADC_RESL mcs51_sfr[0xBE]
+#define _ADC_RESL 0xBE
+
+//SPI
+#define SPSTAT mcs51_sfr[0xCD]
+#define _SPSTAT 0xCD
+#define SPCTL mcs51_sfr[0xCE]
+#define _SPCTL 0xCE
+#define SPDAT mcs51_sfr[0xCF]
+#define _SPDAT 0xCF
+
+//IAP/ISP
+#define IAP_DATA mcs51_sfr[0xC2]
+#define _IAP_DATA 0xC2 
+#define IAP_ADDRH mcs51_sfr[0xC3]
+#define _IAP_ADDRH 0xC3
+#define IAP_ADDRL mcs51_sfr[0xC4]
+#define _IAP_ADDRL 0xC4
+#define IAP_CMD mcs51_sfr[0xC5]
+#define _IAP_CMD 0xC5
+#define IAP_TRIG mcs51_sfr[0xC6]
+#define _IAP_TRIG 0xC6
+#define IAP_CONTR mcs51_sfr[0xC7]
+#define _IAP_CONTR 0xC7 
+
+//PCA/PWM 
+#define CCON mcs51_sfr[0xD8]
+#define _CCON 0xD8 
+#define CF mcs51_bit(0xDF)
+#define _CF 0xDF
+#define CR mcs51_bit(0xDE)
+#define _CR 0xDE
+#define CCF2 mcs51_bit(0xDA)
+#define _CCF2 0xDA
+#define CCF1 mcs51_bit(0xD9)
+#define _CCF1 0xD9
+#define CCF0 mcs51_bit(0xD8)
+#define _CCF0 0xD8
+
+#define CMOD mcs51_sfr[0xD9]
+#define _CMOD 0xD9 
+#define CL mcs51_sfr[0xE9]
+#define _CL 0xE9 
+#define CH mcs51_sfr[0xF9]
+#define _CH 0xF9 
+#define CCAPM0 mcs51_sfr[0xDA]
+#define _CCAPM0 0xDA 
+#define CCAPM1 mcs51_sfr[0xDB]
+#define _CCAPM1 0xDB
+#define CCAPM2 mcs51_sfr[0xDC]
+#define _CCAPM2 0xDC 
+#define CCAP0L mcs51_sfr[0xEA]
+#define _CCAP0L 0xEA 
+#define CCAP1L mcs51_sfr[0xEB]
+#define _CCAP1L 0xEB 
+#define CCAP2L mcs51_sfr[0xEC]
+#define _CCAP2L 0xEC 
+#define PCA_PWM0 mcs51_sfr[0xF2]
+#define _PCA_PWM0 0xF2 
+#define PCA_PWM1 mcs51_sfr[0xF3]
+#define _PCA_PWM1 0xF3 
+#define PCA_PWM2 mcs51_sfr[0xF4]
+#define _PCA_PWM2 0xF4 
+#define CCAP0H mcs51_sfr[0xFA]
+#define _CCAP0H 0xFA 
+#define CCAP1H mcs51_sfr[0xFB]
+#define _CCAP1H 0xFB
+#define CCAP2H mcs51_sfr[0xFC]
+#define _CCAP2H 0xFC 
+
+#define CMPCR1 mcs51_sfr[0xE6]
+#define _CMPCR1 0xE6
+#define CMPCR2 mcs51_sfr[0xE7]
+#define _CMPCR2 0xE7
+
+//PWM
+#define PWMCFG mcs51_sfr[0xf1]
+#define _PWMCFG 0xf1 
+#define PWMCR mcs51_sfr[0xf5]
+#define _PWMCR 0xf5
+#define PWMIF mcs51_sfr[0xf6]
+#define _PWMIF 0xf6
+#define PWMFDCR mcs51_sfr[0xf7]
+#define _PWMFDCR 0xf7
+
+#define PWMC        (*(unsigned int  volatile  *)0xfff0)
+#define PWMCH       (*(unsigned char volatile  *)0xfff0)
+#define PWMCL       (*(unsigned char volatile  *)0xfff1)
+#define PWMCKS      (*(unsigned char volatile  *)0xfff2)
+#define PWM2T1      (*(unsigned int  volatile  *)0xff00)
+#define PWM2T1H     (*(unsigned char volatile  *)0xff00)
+#define PWM2T1L     (*(unsigned char volatile  *)0xff01)
+#define PWM2T2      (*(unsigned int  volatile  *)0xff02)
+#define PWM2T2H     (*(unsigned char volatile  *)0xff02)
+#define PWM2T2L     (*(unsigned char volatile  *)0xff03)
+#define PWM2CR      (*(unsigned char volatile  *)0xff04)
+#define PWM3T1      (*(unsigned int  volatile  *)0xff10)
+#define PWM3T1H     (*(unsigned char volatile  *)0xff10)
+#define PWM3T1L     (*(unsigned char volatile  *)0xff11)
+#define PWM3T2      (*(unsigned int  volatile  *)0xff12)
+#define PWM3T2H     (*(unsigned char volatile  *)0xff12)
+#define PWM3T2L     (*(unsigned char volatile  *)0xff13)
+#define PWM3CR      (*(unsigned char volatile  *)0xff14)
+#define PWM4T1      (*(unsigned int  volatile  *)0xff20)
+#define PWM4T1H     (*(unsigned char volatile  *)0xff20)
+#define PWM4T1L     (*(unsigned char volatile  *)0xff21)
+#define PWM4T2      (*(unsigned int  volatile  *)0xff22)
+#define PWM4T2H     (*(unsigned char volatile  *)0xff22)
+#define PWM4T2L     (*(unsigned char volatile  *)0xff23)
+#define PWM4CR      (*(unsigned char volatile  *)0xff24)
+#define PWM5T1      (*(unsigned int  volatile  *)0xff30)
+#define PWM5T1H     (*(unsigned char volatile  *)0xff30)
+#define PWM5T1L     (*(unsigned char volatile  *)0xff31)
+#define PWM5T2      (*(unsigned int  volatile  *)0xff32)
+#define PWM5T2H     (*(unsigned char volatile  *)0xff32)
+#define PWM5T2L     (*(unsigned char volatile  *)0xff33)
+#define PWM5CR      (*(unsigned char volatile  *)0xff34)
+#define PWM6T1      (*(unsigned int  volatile  *)0xff40)
+#define PWM6T1H     (*(unsigned char volatile  *)0xff40)
+#define PWM6T1L     (*(unsigned char volatile  *)0xff41)
+#define PWM6T2      (*(unsigned int  volatile  *)0xff42)
+#define PWM6T2H     (*(unsigned char volatile  *)0xff42)
+#define PWM6T2L     (*(unsigned char volatile  *)0xff43)
+#define PWM6CR      (*(unsigned char volatile  *)0xff44)
+#define PWM7T1      (*(unsigned int  volatile  *)0xff50)        
+#define PWM7T1H     (*(unsigned char volatile  *)0xff50)        
+#define PWM7T1L     (*(unsigned char volatile  *)0xff51)
+#define PWM7T2      (*(unsigned int  volatile  *)0xff52)
+#define PWM7T2H     (*(unsigned char volatile  *)0xff52)
+#define PWM7T2L     (*(unsigned char volatile  *)0xff53)
+#define PWM7CR      (*(unsigned char volatile  *)0xff54)
+
+#endif
+
@@ -0,0 +1,57 @@
+// telemetry: "name=value" lines out of the UART1 transmitter
+//
+
+#include "telemetry.h"
+
+static uint8_t tm_queue[TM_QUEUE];
+static volatile uint8_t tm_head;
+static volatile uint8_t tm_tail;
+static volatile _Bool tm_busy;
+
+// uart isr, no locals to overlay
+void tm_tx_isr() {
+    if (tm_tail != tm_head)
+        SBUF = tm_queue[tm_tail++ & (TM_QUEUE - 1)];
+    else
+        tm_busy = 0;
+}
+
+void tm_putc(char c) {
+    while ((uint8_t)(tm_head - tm_tail) == TM_QUEUE);
+    ES = 0;
+    if (!tm_busy) {
+        // transmitter idle, TI of this byte sends the queue
+        tm_busy = 1;
+        SBUF = c;
+    } else {
+        tm_queue[tm_head & (TM_QUEUE - 1)] = c;
+        tm_head++;
+    }
+    ES = 1;
+}
+
+void tm_puts( char *s) {
+    while (*s)
+        tm_putc(*s++);
+}
+
+void tm_report( char *name, int16_t value) {
+    char digits[5];
+    uint8_t n = 0;
+    uint16_t v = value;
+
+    tm_puts(name);
+    tm_putc('=');
+    if (value < 0) {
+        tm_putc('-');
+        v = -value;
+    }
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    while (n)
+        tm_putc(digits[--n]);
+    tm_putc('\r');
+    tm_putc('\n');
+}
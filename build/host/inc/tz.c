@@ -0,0 +1,127 @@
+// timezone and daylight saving rule engine
+//
+
+#include "tz.h"
+#include "eeprom.h"
+
+const int month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+// cached window [tz_from, tz_next) of UTC instants (days << 16 | minute of day)
+// with constant offset tz_cur, starts empty
+static uint32_t tz_from;
+static uint32_t tz_next;
+static int16_t  tz_cur;
+
+uint16_t tz_days(uint8_t year, uint8_t month, uint8_t day)
+{
+	uint16_t result = (year * 365) + (year >> 2); //3650 days per year + leap years for every quad
+	uint8_t m;
+	month--;
+	if ((year & 0x3) || month > 1) {
+		//year after leap or march
+		result++;
+	};
+	for (m = 0; m < month; m++) {
+		result += month_days[m];
+	};
+	return result + day;
+}
+
+// UTC instant of transition 'when' (2 rule bytes) in year, local wall time
+// before the transition is bias minutes ahead of UTC
+static uint32_t tz_transition(uint8_t year, uint8_t *when, int16_t bias)
+{
+	uint8_t month = when[0] >> 4;
+	uint8_t week = when[0] & 0x0F;
+	uint8_t mdays = month_days[month - 1] + ((month == 2 && (year & 0x3) == 0) ? 1 : 0);
+	uint16_t days = tz_days(year, month, 1);
+	int16_t minutes;
+	uint8_t day;
+
+	// first wanted weekday of month, 2000-01-01 (day 1) was saturday
+	day = 1 + ((when[1] >> 5) + 7 - (days + 5) % 7) % 7 + (week - 1) * 7;
+	if (day > mdays) day -= 7;      // week 5 = last
+	days += day - 1;
+
+	minutes = (when[1] & 0x1F) * 60 - bias;
+	if (minutes < 0) {
+		days--;
+		minutes += 1440;
+	} else if (minutes >= 1440) {
+		days++;
+		minutes -= 1440;
+	}
+	return (uint32_t)days << 16 | minutes;
+}
+
+#ifdef TZ_SELECT
+static  uint8_t tz_presets[][TZ_RULE_SIZE] = {
+	{ TZ_RULE_MSK }, { TZ_RULE_CET }, { TZ_RULE_UK },
+	{ TZ_RULE_EST }, { TZ_RULE_PST }, { TZ_RULE_AEST }
+};
+#define TZ_PRESETS (sizeof(tz_presets) / TZ_RULE_SIZE)
+
+void tz_select_next()
+{
+	uint8_t p, i;
+	for (p = 0; p != TZ_PRESETS; p++) {
+		for (i = 0; i != TZ_RULE_SIZE; i++)
+			if (cfg_ext[CFG_EXT_TZ + i] != tz_presets[p][i])
+				break;
+		if (i == TZ_RULE_SIZE)
+			break;
+	}
+	// no preset (TZ_PRESETS) or the last one: wrap to the first
+	if (++p >= TZ_PRESETS)
+		p = 0;
+	for (i = 0; i != TZ_RULE_SIZE; i++)
+		cfg_ext[CFG_EXT_TZ + i] = tz_presets[p][i];
+	// empty window, rebuilt on the next lookup
+	tz_from = 0;
+	tz_next = 0;
+}
+#endif
+
+int16_t tz_bias(uint8_t year, uint16_t days, uint16_t minute_of_day)
+{
+	uint32_t t, now = (uint32_t)days << 16 | minute_of_day;
+	int16_t std, dst;
+	uint8_t y;
+	_Bool in_dst = 0, found = 0, next_end = 0;
+
+	if (now >= tz_from && now < tz_next)
+		return tz_cur;
+
+	// crossed a transition (or time jumped): rebuild window from the
+	// transitions of previous, current and next year
+	std = (int8_t)cfg_ext[CFG_EXT_TZ + TZ_OFFSET] * 15;
+	dst = std + cfg_ext[CFG_EXT_TZ + TZ_DST] * 15;
+	tz_cur = std;
+	tz_from = 0;
+	tz_next = 0xFFFFFFFF;
+	if (cfg_ext[CFG_EXT_TZ + TZ_DST] == 0)
+		return tz_cur;
+
+	for (y = year ? year - 1 : 0; y != year + 2; y++) {
+		// dst starts at standard wall time
+		t = tz_transition(y, &cfg_ext[CFG_EXT_TZ + TZ_START], std);
+		if (t <= now) {
+			if (t >= tz_from) { tz_from = t; in_dst = 1; found = 1; }
+		} else if (t < tz_next) {
+			tz_next = t;
+			next_end = 0;
+		}
+		// dst ends at dst wall time
+		t = tz_transition(y, &cfg_ext[CFG_EXT_TZ + TZ_END], dst);
+		if (t <= now) {
+			if (t >= tz_from) { tz_from = t; in_dst = 0; found = 1; }
+		} else if (t < tz_next) {
+			tz_next = t;
+			next_end = 1;
+		}
+	}
+	// no transition before now (early 2000): dst if the next one ends it
+	if (!found) in_dst = next_end;
+	if (in_dst) tz_cur = dst;
+	return tz_cur;
+}
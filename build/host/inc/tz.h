@@ -0,0 +1,44 @@
+// timezone and daylight saving rule engine
+// rule is POSIX TZ like: standard offset, dst delta and start/end transitions
+// as month / week (5 = last) / weekday / hour of local wall time. The UTC
+// window between two transitions is cached, so a lookup is one comparison
+// until the next transition is crossed.
+//
+
+#include <stdint.h>
+
+// rule bytes in cfg_ext (see eeprom.h)
+#define TZ_OFFSET   0       // standard offset to UTC, int8, 15min units
+#define TZ_DST      1       // dst delta, 15min units, 0 = no dst
+#define TZ_START    2       // 2 bytes, see TZ_WHEN
+#define TZ_END      4       // 2 bytes, see TZ_WHEN
+#define TZ_RULE_SIZE 6
+
+// transition: month (1-12) / week (1-4, 5 = last) | weekday (0 = sunday) / hour
+#define TZ_WHEN(month, week, weekday, hour) ((month) << 4 | (week)), ((weekday) << 5 | (hour))
+
+// some rules, pass one as -DTZ_RULE_DEFAULT=... to change the default
+#define TZ_RULE_MSK  12, 0, 0, 0, 0, 0                                      // UTC+3
+#define TZ_RULE_CET  4, 4, TZ_WHEN(3, 5, 0, 2), TZ_WHEN(10, 5, 0, 3)         // central europe
+#define TZ_RULE_UK   0, 4, TZ_WHEN(3, 5, 0, 1), TZ_WHEN(10, 5, 0, 2)         // london
+#define TZ_RULE_EST  -20, 4, TZ_WHEN(3, 2, 0, 2), TZ_WHEN(11, 1, 0, 2)      // us eastern
+#define TZ_RULE_PST  -32, 4, TZ_WHEN(3, 2, 0, 2), TZ_WHEN(11, 1, 0, 2)      // us pacific
+#define TZ_RULE_AEST 40, 4, TZ_WHEN(10, 1, 0, 2), TZ_WHEN(4, 1, 0, 3)       // sydney
+
+#ifndef TZ_RULE_DEFAULT
+#define TZ_RULE_DEFAULT TZ_RULE_MSK
+#endif
+
+extern const int month_days[12];
+
+// days since 2000-01-00 of a date in 2000-2099
+uint16_t tz_days(uint8_t year, uint8_t month, uint8_t day);
+
+// local time offset in minutes for a UTC instant
+int16_t tz_bias(uint8_t year, uint16_t days, uint16_t minute_of_day);
+
+#ifdef TZ_SELECT
+// rule set from the keys: replaces the rule in cfg_ext by the preset after
+// it (the first one when it is no preset), TZ_RULE_MSK .. TZ_RULE_AEST
+void tz_select_next();
+#endif
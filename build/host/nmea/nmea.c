@@ -0,0 +1,551 @@
+# 0 "build/host/inc/nmea.c"
+# 0 "<built-in>"
+# 0 "<command-line>"
+# 1 "/usr/include/stdc-predef.h" 1 3 4
+# 0 "<command-line>" 2
+# 1 "build/host/inc/nmea.c"
+
+
+
+
+
+
+
+# 1 "build/host/inc/nmea.h" 1
+
+
+
+
+# 1 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 1 3 4
+# 9 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 3 4
+# 1 "/usr/include/stdint.h" 1 3 4
+# 26 "/usr/include/stdint.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 1 3 4
+# 33 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 3 4
+# 1 "/usr/include/features.h" 1 3 4
+# 392 "/usr/include/features.h" 3 4
+# 1 "/usr/include/features-time64.h" 1 3 4
+# 20 "/usr/include/features-time64.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 21 "/usr/include/features-time64.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 22 "/usr/include/features-time64.h" 2 3 4
+# 393 "/usr/include/features.h" 2 3 4
+# 489 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 1 3 4
+# 561 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 562 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/long-double.h" 1 3 4
+# 563 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 490 "/usr/include/features.h" 2 3 4
+# 513 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 1 3 4
+# 10 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs-64.h" 1 3 4
+# 11 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 2 3 4
+# 514 "/usr/include/features.h" 2 3 4
+# 34 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 2 3 4
+# 27 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/types.h" 1 3 4
+# 27 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 28 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 29 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+
+# 31 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+typedef unsigned char __u_char;
+typedef unsigned short int __u_short;
+typedef unsigned int __u_int;
+typedef unsigned long int __u_long;
+
+
+typedef signed char __int8_t;
+typedef unsigned char __uint8_t;
+typedef signed short int __int16_t;
+typedef unsigned short int __uint16_t;
+typedef signed int __int32_t;
+typedef unsigned int __uint32_t;
+
+typedef signed long int __int64_t;
+typedef unsigned long int __uint64_t;
+
+
+
+
+
+
+typedef __int8_t __int_least8_t;
+typedef __uint8_t __uint_least8_t;
+typedef __int16_t __int_least16_t;
+typedef __uint16_t __uint_least16_t;
+typedef __int32_t __int_least32_t;
+typedef __uint32_t __uint_least32_t;
+typedef __int64_t __int_least64_t;
+typedef __uint64_t __uint_least64_t;
+
+
+
+typedef long int __quad_t;
+typedef unsigned long int __u_quad_t;
+
+
+
+
+
+
+
+typedef long int __intmax_t;
+typedef unsigned long int __uintmax_t;
+# 141 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/typesizes.h" 1 3 4
+# 142 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/time64.h" 1 3 4
+# 143 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+typedef unsigned long int __dev_t;
+typedef unsigned int __uid_t;
+typedef unsigned int __gid_t;
+typedef unsigned long int __ino_t;
+typedef unsigned long int __ino64_t;
+typedef unsigned int __mode_t;
+typedef unsigned long int __nlink_t;
+typedef long int __off_t;
+typedef long int __off64_t;
+typedef int __pid_t;
+typedef struct { int __val[2]; } __fsid_t;
+typedef long int __clock_t;
+typedef unsigned long int __rlim_t;
+typedef unsigned long int __rlim64_t;
+typedef unsigned int __id_t;
+typedef long int __time_t;
+typedef unsigned int __useconds_t;
+typedef long int __suseconds_t;
+typedef long int __suseconds64_t;
+
+typedef int __daddr_t;
+typedef int __key_t;
+
+
+typedef int __clockid_t;
+
+
+typedef void * __timer_t;
+
+
+typedef long int __blksize_t;
+
+
+
+
+typedef long int __blkcnt_t;
+typedef long int __blkcnt64_t;
+
+
+typedef unsigned long int __fsblkcnt_t;
+typedef unsigned long int __fsblkcnt64_t;
+
+
+typedef unsigned long int __fsfilcnt_t;
+typedef unsigned long int __fsfilcnt64_t;
+
+
+typedef long int __fsword_t;
+
+typedef long int __ssize_t;
+
+
+typedef long int __syscall_slong_t;
+
+typedef unsigned long int __syscall_ulong_t;
+
+
+
+typedef __off64_t __loff_t;
+typedef char *__caddr_t;
+
+
+typedef long int __intptr_t;
+
+
+typedef unsigned int __socklen_t;
+
+
+
+
+typedef int __sig_atomic_t;
+# 28 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wchar.h" 1 3 4
+# 29 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 30 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 3 4
+typedef __int8_t int8_t;
+typedef __int16_t int16_t;
+typedef __int32_t int32_t;
+typedef __int64_t int64_t;
+# 35 "/usr/include/stdint.h" 2 3 4
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 3 4
+typedef __uint8_t uint8_t;
+typedef __uint16_t uint16_t;
+typedef __uint32_t uint32_t;
+typedef __uint64_t uint64_t;
+# 38 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+
+typedef __int_least8_t int_least8_t;
+typedef __int_least16_t int_least16_t;
+typedef __int_least32_t int_least32_t;
+typedef __int_least64_t int_least64_t;
+
+
+typedef __uint_least8_t uint_least8_t;
+typedef __uint_least16_t uint_least16_t;
+typedef __uint_least32_t uint_least32_t;
+typedef __uint_least64_t uint_least64_t;
+
+
+
+
+
+typedef signed char int_fast8_t;
+
+typedef long int int_fast16_t;
+typedef long int int_fast32_t;
+typedef long int int_fast64_t;
+# 71 "/usr/include/stdint.h" 3 4
+typedef unsigned char uint_fast8_t;
+
+typedef unsigned long int uint_fast16_t;
+typedef unsigned long int uint_fast32_t;
+typedef unsigned long int uint_fast64_t;
+# 87 "/usr/include/stdint.h" 3 4
+typedef long int intptr_t;
+
+
+typedef unsigned long int uintptr_t;
+# 101 "/usr/include/stdint.h" 3 4
+typedef __intmax_t intmax_t;
+typedef __uintmax_t uintmax_t;
+# 10 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 2 3 4
+# 6 "build/host/inc/nmea.h" 2
+
+
+
+# 8 "build/host/inc/nmea.h"
+extern volatile uint8_t gpstm_table[8];
+
+
+extern volatile _Bool gpstm_needupdate;
+
+
+
+extern volatile uint16_t nmea_bytes;
+extern volatile uint16_t nmea_sentences;
+extern volatile uint16_t nmea_zda;
+
+
+
+void nmea_feed(uint8_t data);
+# 9 "build/host/inc/nmea.c" 2
+# 1 "build/host/inc/ds1302.h" 1
+
+
+
+
+# 1 "build/host/inc/stc15.h" 1
+
+
+
+# 1 "build/host/inc/8051.h" 1
+# 1 "test/mcs51.h" 1
+# 11 "test/mcs51.h"
+extern volatile uint8_t mcs51_iram[256];
+extern volatile uint8_t mcs51_sfr[256];
+
+
+
+uint8_t mcs51_bit(uint8_t addr);
+void mcs51_setbit(uint8_t addr, uint8_t v);
+
+
+
+
+
+
+
+extern void (*mcs51_pin_write)(uint8_t addr, uint8_t v);
+extern uint8_t (*mcs51_pin_read)(uint8_t addr, uint8_t latch);
+
+
+
+
+
+
+
+void mcs51_asm(const char *text);
+extern unsigned long mcs51_clocks;
+# 2 "build/host/inc/8051.h" 2
+# 5 "build/host/inc/stc15.h" 2
+# 6 "build/host/inc/ds1302.h" 2
+# 171 "build/host/inc/ds1302.h"
+void ds_ram_config_init();
+void ds_ram_config_write();
+
+
+
+void ds_ram_writeburst( uint8_t *buf, uint8_t len);
+
+
+
+uint8_t ds_ram_readburst( uint8_t *buf, uint8_t len);
+
+
+uint8_t ds_readbyte(uint8_t addr);
+
+
+void ds_readburst();
+
+
+void ds_writebyte(uint8_t addr, uint8_t data);
+
+
+void ds_init();
+
+
+void ds_reset_clock();
+
+
+void ds_hours_12_24_toggle();
+
+
+void ds_hours_incr();
+
+
+void ds_minutes_incr();
+
+
+void ds_month_incr();
+
+
+void ds_day_incr();
+
+void ds_weekday_incr();
+void ds_sec_zero();
+
+
+uint8_t ds_hour24();
+
+
+uint8_t ds_split2int(uint8_t tens_ones);
+
+
+uint8_t ds_int2bcd(uint8_t integer);
+
+
+uint8_t ds_int2bcd_tens(uint8_t integer);
+uint8_t ds_int2bcd_ones(uint8_t integer);
+# 10 "build/host/inc/nmea.c" 2
+
+
+enum nmea_state {
+ NM_UNKNOWN,
+ NM_HEADER,
+ NM_ZDATIME,
+ NM_ZDAFRACRIONSECONDS,
+ NM_ZDADAY,
+ NM_ZDAMONTH,
+ NM_ZDAYEAR,
+ NM_ZDATZHOUR,
+ NM_ZDATZMINUTE,
+ NM_ZDACHECKSUM
+};
+static uint8_t zda_state = NM_UNKNOWN;
+static uint8_t zda_state_pos = 0;
+static uint8_t zda_checksum = 0;
+
+
+
+volatile uint8_t gpstm_table[8];
+volatile _Bool gpstm_needupdate = 0;
+
+
+volatile uint16_t nmea_bytes;
+volatile uint16_t nmea_sentences;
+volatile uint16_t nmea_zda;
+# 57 "build/host/inc/nmea.c"
+void nmea_feed(uint8_t data)
+{
+
+ nmea_bytes++;
+ if (data == '$') nmea_sentences++;
+
+ if (gpstm_needupdate == 1) {
+
+  return;
+ }
+ if (data == '$') {
+  zda_state = NM_HEADER; zda_state_pos = 0;;
+
+  zda_checksum = '*';
+ } else if (zda_state == NM_UNKNOWN) {
+
+  return;
+ } else if (zda_state == NM_ZDACHECKSUM) {
+  uint8_t digit;
+  if (data >= '0' && data <= '9') {
+   digit = data - '0';
+  } else if (data >= 'A' && data <= 'F') {
+   digit = data - 'A' + 10;
+  } else {
+   zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   return;
+  }
+  if (zda_state_pos == 0) {
+   zda_checksum ^= digit << 4;
+   zda_state_pos = 1;
+  } else {
+
+   if (zda_checksum == digit) {
+    gpstm_needupdate = 1;
+   }
+   zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+  }
+
+ } else {
+  zda_checksum ^= data;
+  if (zda_state == NM_HEADER) {
+   if (zda_state_pos == 0 && data == 'G') {
+   } else if (zda_state_pos == 1 && data == 'P') {
+   } else if (zda_state_pos == 2 && data == 'Z') {
+   } else if (zda_state_pos == 3 && data == 'D') {
+   } else if (zda_state_pos == 4 && data == 'A') {
+   } else if (zda_state_pos == 5 && data == ',') {
+
+    nmea_zda++;
+
+    zda_state = NM_ZDATIME; zda_state_pos = 0;;
+    return;
+   } else {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+    return;
+   }
+   zda_state_pos++;
+  } else if (zda_state == NM_ZDATIME) {
+   if (data == '.' && zda_state_pos == 6) {
+    zda_state = NM_ZDAFRACRIONSECONDS; zda_state_pos = 0;;
+    return;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+    return;
+   } else {
+    uint8_t time_part;
+    if (zda_state_pos < 2) {
+     time_part = 2;
+    } else if (zda_state_pos < 4) {
+     time_part = 1;
+    } else if (zda_state_pos < 6) {
+     time_part = 0;
+    } else {
+     zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+     return;
+    };
+    if ((zda_state_pos & 0x01) == 0) {
+     gpstm_table[time_part] = (data - '0') << 4;
+    } else {
+     gpstm_table[time_part] = gpstm_table[time_part] + (data - '0');
+    }
+    zda_state_pos++;
+   }
+  } else if (zda_state == NM_ZDAFRACRIONSECONDS) {
+   if (data == ',') {
+    zda_state = NM_ZDADAY; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   }
+  } else if (zda_state == NM_ZDADAY) {
+   if (data == ',') {
+    zda_state = NM_ZDAMONTH; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   } else {
+    if (zda_state_pos == 0) {
+     gpstm_table[3] = (data - '0') << 4;
+    } else if (zda_state_pos == 1) {
+     gpstm_table[3] = gpstm_table[3] + (data - '0');
+    } else {
+     zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+     return;
+    }
+    zda_state_pos++;
+   }
+  } else if (zda_state == NM_ZDAMONTH) {
+   if (data == ',') {
+    zda_state = NM_ZDAYEAR; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   } else {
+    if (zda_state_pos == 0) {
+     gpstm_table[4] = (data - '0') << 4;
+    } else if (zda_state_pos == 1) {
+     gpstm_table[4] = gpstm_table[4] + (data - '0');
+    } else {
+     zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+     return;
+    }
+    zda_state_pos++;
+   }
+  } else if (zda_state == NM_ZDAYEAR) {
+   if (data == ',') {
+    zda_state = NM_ZDATZHOUR; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   } else {
+    if (zda_state_pos < 2) {
+
+    } else if (zda_state_pos == 2) {
+     gpstm_table[6] = (data - '0') << 4;
+    } else if (zda_state_pos == 3) {
+     gpstm_table[6] = gpstm_table[6] + (data - '0');
+    } else {
+     zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+     return;
+    }
+    zda_state_pos++;
+   }
+  } else if (zda_state == NM_ZDATZHOUR) {
+   if (data == ',') {
+    zda_state = NM_ZDATZMINUTE; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   }
+  } else if (zda_state == NM_ZDATZMINUTE) {
+   if (data == '*') {
+    zda_state = NM_ZDACHECKSUM; zda_state_pos = 0;;
+   } else if (data < '0' || data > '9') {
+    zda_state = NM_UNKNOWN; zda_state_pos = 0;;
+   }
+  }
+ }
+}
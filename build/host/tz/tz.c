@@ -0,0 +1,449 @@
+# 0 "build/host/inc/tz.c"
+# 0 "<built-in>"
+# 0 "<command-line>"
+# 1 "/usr/include/stdc-predef.h" 1 3 4
+# 0 "<command-line>" 2
+# 1 "build/host/inc/tz.c"
+
+
+
+# 1 "build/host/inc/tz.h" 1
+
+
+
+
+
+
+
+# 1 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 1 3 4
+# 9 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 3 4
+# 1 "/usr/include/stdint.h" 1 3 4
+# 26 "/usr/include/stdint.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 1 3 4
+# 33 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 3 4
+# 1 "/usr/include/features.h" 1 3 4
+# 392 "/usr/include/features.h" 3 4
+# 1 "/usr/include/features-time64.h" 1 3 4
+# 20 "/usr/include/features-time64.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 21 "/usr/include/features-time64.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 22 "/usr/include/features-time64.h" 2 3 4
+# 393 "/usr/include/features.h" 2 3 4
+# 489 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 1 3 4
+# 561 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 562 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/long-double.h" 1 3 4
+# 563 "/usr/include/x86_64-linux-gnu/sys/cdefs.h" 2 3 4
+# 490 "/usr/include/features.h" 2 3 4
+# 513 "/usr/include/features.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 1 3 4
+# 10 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/gnu/stubs-64.h" 1 3 4
+# 11 "/usr/include/x86_64-linux-gnu/gnu/stubs.h" 2 3 4
+# 514 "/usr/include/features.h" 2 3 4
+# 34 "/usr/include/x86_64-linux-gnu/bits/libc-header-start.h" 2 3 4
+# 27 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/types.h" 1 3 4
+# 27 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 28 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 1 3 4
+# 19 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 20 "/usr/include/x86_64-linux-gnu/bits/timesize.h" 2 3 4
+# 29 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+
+# 31 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+typedef unsigned char __u_char;
+typedef unsigned short int __u_short;
+typedef unsigned int __u_int;
+typedef unsigned long int __u_long;
+
+
+typedef signed char __int8_t;
+typedef unsigned char __uint8_t;
+typedef signed short int __int16_t;
+typedef unsigned short int __uint16_t;
+typedef signed int __int32_t;
+typedef unsigned int __uint32_t;
+
+typedef signed long int __int64_t;
+typedef unsigned long int __uint64_t;
+
+
+
+
+
+
+typedef __int8_t __int_least8_t;
+typedef __uint8_t __uint_least8_t;
+typedef __int16_t __int_least16_t;
+typedef __uint16_t __uint_least16_t;
+typedef __int32_t __int_least32_t;
+typedef __uint32_t __uint_least32_t;
+typedef __int64_t __int_least64_t;
+typedef __uint64_t __uint_least64_t;
+
+
+
+typedef long int __quad_t;
+typedef unsigned long int __u_quad_t;
+
+
+
+
+
+
+
+typedef long int __intmax_t;
+typedef unsigned long int __uintmax_t;
+# 141 "/usr/include/x86_64-linux-gnu/bits/types.h" 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/typesizes.h" 1 3 4
+# 142 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/time64.h" 1 3 4
+# 143 "/usr/include/x86_64-linux-gnu/bits/types.h" 2 3 4
+
+
+typedef unsigned long int __dev_t;
+typedef unsigned int __uid_t;
+typedef unsigned int __gid_t;
+typedef unsigned long int __ino_t;
+typedef unsigned long int __ino64_t;
+typedef unsigned int __mode_t;
+typedef unsigned long int __nlink_t;
+typedef long int __off_t;
+typedef long int __off64_t;
+typedef int __pid_t;
+typedef struct { int __val[2]; } __fsid_t;
+typedef long int __clock_t;
+typedef unsigned long int __rlim_t;
+typedef unsigned long int __rlim64_t;
+typedef unsigned int __id_t;
+typedef long int __time_t;
+typedef unsigned int __useconds_t;
+typedef long int __suseconds_t;
+typedef long int __suseconds64_t;
+
+typedef int __daddr_t;
+typedef int __key_t;
+
+
+typedef int __clockid_t;
+
+
+typedef void * __timer_t;
+
+
+typedef long int __blksize_t;
+
+
+
+
+typedef long int __blkcnt_t;
+typedef long int __blkcnt64_t;
+
+
+typedef unsigned long int __fsblkcnt_t;
+typedef unsigned long int __fsblkcnt64_t;
+
+
+typedef unsigned long int __fsfilcnt_t;
+typedef unsigned long int __fsfilcnt64_t;
+
+
+typedef long int __fsword_t;
+
+typedef long int __ssize_t;
+
+
+typedef long int __syscall_slong_t;
+
+typedef unsigned long int __syscall_ulong_t;
+
+
+
+typedef __off64_t __loff_t;
+typedef char *__caddr_t;
+
+
+typedef long int __intptr_t;
+
+
+typedef unsigned int __socklen_t;
+
+
+
+
+typedef int __sig_atomic_t;
+# 28 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wchar.h" 1 3 4
+# 29 "/usr/include/stdint.h" 2 3 4
+# 1 "/usr/include/x86_64-linux-gnu/bits/wordsize.h" 1 3 4
+# 30 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-intn.h" 3 4
+typedef __int8_t int8_t;
+typedef __int16_t int16_t;
+typedef __int32_t int32_t;
+typedef __int64_t int64_t;
+# 35 "/usr/include/stdint.h" 2 3 4
+
+
+# 1 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 1 3 4
+# 24 "/usr/include/x86_64-linux-gnu/bits/stdint-uintn.h" 3 4
+typedef __uint8_t uint8_t;
+typedef __uint16_t uint16_t;
+typedef __uint32_t uint32_t;
+typedef __uint64_t uint64_t;
+# 38 "/usr/include/stdint.h" 2 3 4
+
+
+
+
+
+typedef __int_least8_t int_least8_t;
+typedef __int_least16_t int_least16_t;
+typedef __int_least32_t int_least32_t;
+typedef __int_least64_t int_least64_t;
+
+
+typedef __uint_least8_t uint_least8_t;
+typedef __uint_least16_t uint_least16_t;
+typedef __uint_least32_t uint_least32_t;
+typedef __uint_least64_t uint_least64_t;
+
+
+
+
+
+typedef signed char int_fast8_t;
+
+typedef long int int_fast16_t;
+typedef long int int_fast32_t;
+typedef long int int_fast64_t;
+# 71 "/usr/include/stdint.h" 3 4
+typedef unsigned char uint_fast8_t;
+
+typedef unsigned long int uint_fast16_t;
+typedef unsigned long int uint_fast32_t;
+typedef unsigned long int uint_fast64_t;
+# 87 "/usr/include/stdint.h" 3 4
+typedef long int intptr_t;
+
+
+typedef unsigned long int uintptr_t;
+# 101 "/usr/include/stdint.h" 3 4
+typedef __intmax_t intmax_t;
+typedef __uintmax_t uintmax_t;
+# 10 "/usr/lib/gcc/x86_64-linux-gnu/12/include/stdint.h" 2 3 4
+# 9 "build/host/inc/tz.h" 2
+# 32 "build/host/inc/tz.h"
+
+# 32 "build/host/inc/tz.h"
+extern const int month_days[12];
+
+
+uint16_t tz_days(uint8_t year, uint8_t month, uint8_t day);
+
+
+int16_t tz_bias(uint8_t year, uint16_t days, uint16_t minute_of_day);
+
+
+
+
+void tz_select_next();
+# 5 "build/host/inc/tz.c" 2
+# 1 "build/host/inc/eeprom.h" 1
+
+
+
+
+# 1 "build/host/inc/stc15.h" 1
+
+
+
+# 1 "build/host/inc/8051.h" 1
+# 1 "test/mcs51.h" 1
+# 11 "test/mcs51.h"
+extern volatile uint8_t mcs51_iram[256];
+extern volatile uint8_t mcs51_sfr[256];
+
+
+
+uint8_t mcs51_bit(uint8_t addr);
+void mcs51_setbit(uint8_t addr, uint8_t v);
+
+
+
+
+
+
+
+extern void (*mcs51_pin_write)(uint8_t addr, uint8_t v);
+extern uint8_t (*mcs51_pin_read)(uint8_t addr, uint8_t latch);
+
+
+
+
+
+
+
+void mcs51_asm(const char *text);
+extern unsigned long mcs51_clocks;
+# 2 "build/host/inc/8051.h" 2
+# 5 "build/host/inc/stc15.h" 2
+# 6 "build/host/inc/eeprom.h" 2
+# 47 "build/host/inc/eeprom.h"
+extern uint8_t cfg_ext[((16 - 1) - 4)];
+
+
+uint8_t ee_readbyte(uint16_t addr);
+
+
+void ee_writebyte(uint16_t addr, uint8_t data);
+
+
+void ee_erase(uint16_t addr);
+
+
+
+
+void ee_config_init();
+
+
+void ee_config_save();
+# 6 "build/host/inc/tz.c" 2
+
+const int month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+
+
+static uint32_t tz_from;
+static uint32_t tz_next;
+static int16_t tz_cur;
+
+uint16_t tz_days(uint8_t year, uint8_t month, uint8_t day)
+{
+ uint16_t result = (year * 365) + (year >> 2);
+ uint8_t m;
+ month--;
+ if ((year & 0x3) || month > 1) {
+
+  result++;
+ };
+ for (m = 0; m < month; m++) {
+  result += month_days[m];
+ };
+ return result + day;
+}
+
+
+
+static uint32_t tz_transition(uint8_t year, uint8_t *when, int16_t bias)
+{
+ uint8_t month = when[0] >> 4;
+ uint8_t week = when[0] & 0x0F;
+ uint8_t mdays = month_days[month - 1] + ((month == 2 && (year & 0x3) == 0) ? 1 : 0);
+ uint16_t days = tz_days(year, month, 1);
+ int16_t minutes;
+ uint8_t day;
+
+
+ day = 1 + ((when[1] >> 5) + 7 - (days + 5) % 7) % 7 + (week - 1) * 7;
+ if (day > mdays) day -= 7;
+ days += day - 1;
+
+ minutes = (when[1] & 0x1F) * 60 - bias;
+ if (minutes < 0) {
+  days--;
+  minutes += 1440;
+ } else if (minutes >= 1440) {
+  days++;
+  minutes -= 1440;
+ }
+ return (uint32_t)days << 16 | minutes;
+}
+
+
+static uint8_t tz_presets[][6] = {
+ { 12, 0, 0, 0, 0, 0 }, { 4, 4, ((3) << 4 | (5)), ((0) << 5 | (2)), ((10) << 4 | (5)), ((0) << 5 | (3)) }, { 0, 4, ((3) << 4 | (5)), ((0) << 5 | (1)), ((10) << 4 | (5)), ((0) << 5 | (2)) },
+ { -20, 4, ((3) << 4 | (2)), ((0) << 5 | (2)), ((11) << 4 | (1)), ((0) << 5 | (2)) }, { -32, 4, ((3) << 4 | (2)), ((0) << 5 | (2)), ((11) << 4 | (1)), ((0) << 5 | (2)) }, { 40, 4, ((10) << 4 | (1)), ((0) << 5 | (2)), ((4) << 4 | (1)), ((0) << 5 | (3)) }
+};
+
+
+void tz_select_next()
+{
+ uint8_t p, i;
+ for (p = 0; p != (sizeof(tz_presets) / 6); p++) {
+  for (i = 0; i != 6; i++)
+   if (cfg_ext[0 + i] != tz_presets[p][i])
+    break;
+  if (i == 6)
+   break;
+ }
+
+ if (++p >= (sizeof(tz_presets) / 6))
+  p = 0;
+ for (i = 0; i != 6; i++)
+  cfg_ext[0 + i] = tz_presets[p][i];
+
+ tz_from = 0;
+ tz_next = 0;
+}
+
+
+int16_t tz_bias(uint8_t year, uint16_t days, uint16_t minute_of_day)
+{
+ uint32_t t, now = (uint32_t)days << 16 | minute_of_day;
+ int16_t std, dst;
+ uint8_t y;
+ _Bool in_dst = 0, found = 0, next_end = 0;
+
+ if (now >= tz_from && now < tz_next)
+  return tz_cur;
+
+
+
+ std = (int8_t)cfg_ext[0 + 0] * 15;
+ dst = std + cfg_ext[0 + 1] * 15;
+ tz_cur = std;
+ tz_from = 0;
+ tz_next = 0xFFFFFFFF;
+ if (cfg_ext[0 + 1] == 0)
+  return tz_cur;
+
+ for (y = year ? year - 1 : 0; y != year + 2; y++) {
+
+  t = tz_transition(y, &cfg_ext[0 + 2], std);
+  if (t <= now) {
+   if (t >= tz_from) { tz_from = t; in_dst = 1; found = 1; }
+  } else if (t < tz_next) {
+   tz_next = t;
+   next_end = 0;
+  }
+
+  t = tz_transition(y, &cfg_ext[0 + 4], dst);
+  if (t <= now) {
+   if (t >= tz_from) { tz_from = t; in_dst = 0; found = 1; }
+  } else if (t < tz_next) {
+   tz_next = t;
+   next_end = 1;
+  }
+ }
+
+ if (!found) in_dst = next_end;
+ if (in_dst) tz_cur = dst;
+ return tz_cur;
+}
@@ -17,6 +17,8 @@
 #include "stc15.h"
 #include "adc.h"
 
+volatile uint8_t adc_start;
+
 /*----------------------------
 Initial ADC sfr
 ----------------------------*/
@@ -40,7 +42,12 @@ uint16_t getADCResult(uint8_t chan)
 
 uint8_t getADCResult8(uint8_t chan)
 {
+#ifdef ADC_FREERUN
 	ADC_CONTR = ADC_POWER | ADC_SPEEDHH | ADC_START | chan;
+#else
+	adc_start = ADC_POWER | ADC_SPEEDHH | ADC_START | chan;
+	while (adc_start);                //Started by the display isr
+#endif
 	_nop_;       //Must wait before inquiry
 	while (!(ADC_CONTR & ADC_FLAG));  //Wait complete flag
 	ADC_CONTR &= ~ADC_FLAG;           //Close ADC
@@ -28,6 +28,12 @@
 #define ADC_SPEEDH  0x40            //180 clocks
 #define ADC_SPEEDHH 0x60            //90 clocks
 
+// conversion start requested from the display isr: ADC_CONTR value, the isr
+// writes it with all digits off, keeps that 100us period dark and clears it.
+// Samples are taken without segment current on the supply, the display
+// timer must be running. ADC_FREERUN starts conversions directly instead.
+extern volatile uint8_t adc_start;
+
 /*----------------------------
 Initialize ADC sfr
 ----------------------------*/
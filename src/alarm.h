@@ -0,0 +1,38 @@
+// alarm and hourly chime scheduler
+// next event is precomputed as minute of day, so only one comparison is
+// needed per minute rollover
+//
+
+#include <stdint.h>
+
+#define MINUTES_PER_DAY 1440
+#define ALARM_NO_EVENT  0xFFFF
+
+// event returned by alarm_check()
+#define ALARM_NONE      0
+#define ALARM_ALARM     1
+#define ALARM_CHIME     2
+
+#ifdef ALARM
+
+// current rtc time as minute of day (0..1439), 12h mode converted to 24h
+uint16_t alarm_minute_of_day();
+
+// recompute next event at next minute rollover
+// call after alarm/chime config changed
+void alarm_reschedule();
+
+// call after ds_readburst(), returns event due in this minute
+// (once, on the rollover) or ALARM_NONE
+uint8_t alarm_check();
+
+// alarm/chime config setters (24h format), reschedule on change
+void alarm_hour_incr();
+void alarm_minute_incr();
+void chime_start_incr();
+void chime_stop_incr();
+
+#else
+#define alarm_reschedule()
+#define alarm_check() ALARM_NONE
+#endif
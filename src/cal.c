@@ -0,0 +1,81 @@
+// internal RC oscillator calibration against the DS1302 second
+//
+
+#include "cal.h"
+#include "ds1302.h"
+#include "eeprom.h"
+
+static uint8_t cal_ovf;
+
+// wait for the next DS1302 second, counting PCA overflows, 0 on timeout
+static uint8_t cal_second() {
+    uint8_t s = ds_readbyte(DS_ADDR_SECONDS);
+    while (ds_readbyte(DS_ADDR_SECONDS) == s) {
+        if (CF) {
+            CF = 0;
+            if (++cal_ovf == CAL_OVF_MAX) return 0;
+        }
+    }
+    return 1;
+}
+
+static void cal_start() {
+    CR = 0;
+    CL = 0;
+    CH = 0;
+    CF = 0;
+    cal_ovf = 0;
+    CR = 1;
+}
+
+uint16_t cal_measure() {
+    uint8_t n, ok;
+    uint32_t count;
+
+    CMOD = 0x00;                // SYSclk/12, no overflow interrupt
+    cal_start();
+    ok = cal_second();
+
+    // count from this second boundary on, polling latency is the same at
+    // both ends
+    cal_start();
+    for (n=0; ok && n!=CAL_SECONDS; n++)
+        ok = cal_second();
+    CR = 0;
+    if (!ok) return 0;
+    if (CF) cal_ovf++;
+
+    // clock / 256 = count * 12 / 256 / CAL_SECONDS
+    count = (uint32_t)cal_ovf << 16 | (uint16_t)(CH << 8 | CL);
+    count = count * 3 / (64 * CAL_SECONDS);
+    if (count < CAL_MIN || count > CAL_MAX) return 0;
+    return count;
+}
+
+uint16_t cal_get() {
+    return cfg_ext[CFG_EXT_CAL] | cfg_ext[CFG_EXT_CAL + 1] << 8;
+}
+
+void cal_set(uint16_t clock) {
+    cfg_ext[CFG_EXT_CAL] = clock;
+    cfg_ext[CFG_EXT_CAL + 1] = clock >> 8;
+}
+
+static uint16_t cal_clock() {
+    uint16_t c = cal_get();
+    return c ? c : CAL_NOMINAL;
+}
+
+uint16_t cal_t0_clocks() {
+    // clock / 10000, rounded
+    return ((uint32_t)cal_clock() * 16 + 312) / 625;
+}
+
+uint16_t cal_t2_clocks() {
+    // clock / 4 / BAUD, rounded
+    return ((uint32_t)cal_clock() * 64 + BAUD / 2) / BAUD;
+}
+
+int16_t cal_error() {
+    return ((int32_t)cal_clock() - CAL_NOMINAL) * 10000 / CAL_NOMINAL;
+}
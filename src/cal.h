@@ -0,0 +1,50 @@
+// internal RC oscillator calibration against the DS1302 second
+// PCA clocks (SYSclk/12) are counted over CAL_SECONDS second boundaries of the
+// DS1302, the measured clock sets the Timer0 (display refresh, 10ms tick) and
+// Timer2 (uart baud) reloads. _delay_ms stays a fixed instruction loop.
+//
+
+#include "stc15.h"
+#include <stdint.h>
+
+// nominal system clock, set by stcgal/stc-isp
+#define FOSC        11059200
+#define BAUD        9600
+
+// measurement length, resolution is about 30ppm / CAL_SECONDS
+#define CAL_SECONDS 2
+// give up after this many PCA overflows (71ms each) without enough seconds
+#define CAL_OVF_MAX 60
+
+// clock in 256Hz units, as kept in config, 0 when not calibrated
+#define CAL_NOMINAL (FOSC / 256)
+// accepted measurement, +-10%
+#define CAL_MIN     (CAL_NOMINAL - CAL_NOMINAL / 10)
+#define CAL_MAX     (CAL_NOMINAL + CAL_NOMINAL / 10)
+
+#ifdef RC_CAL
+
+// measure system clock, the PCA counter is taken over and left stopped.
+// Interrupts may run: a second boundary is seen up to one isr late, a few
+// hundred clocks of the ~22M counted, below the 23ppm step of the result
+// returns clock / 256 or 0 if the DS1302 doesn't tick or the result is off
+uint16_t cal_measure();
+
+// stored calibration (cfg_ext, saved with the config), 0 for none
+uint16_t cal_get();
+void cal_set(uint16_t clock);
+
+// Timer0 1T clocks per 100us refresh tick
+uint16_t cal_t0_clocks();
+
+// Timer2 1T clocks per 4 uart bits (S1ST2 mode 1 baud rate)
+uint16_t cal_t2_clocks();
+
+// clock error in 0.01% against FOSC
+int16_t cal_error();
+
+#else
+// nominal clock
+#define cal_t0_clocks() ((FOSC + 5000) / 10000)
+#define cal_t2_clocks() ((FOSC / 4 + BAUD / 2) / BAUD)
+#endif
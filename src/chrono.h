@@ -0,0 +1,40 @@
+// stopwatch and countdown timer
+// both count in BCD in the 10ms tick isr, the main loop only renders them
+// and handles keys. Counters: [0] 1/100 s, [1] seconds, [2] minutes
+//
+
+#include <stdint.h>
+
+#define CHRONO_HSEC 0
+#define CHRONO_SEC  1
+#define CHRONO_MIN  2
+
+extern volatile uint8_t chrono_up[3];      // stopwatch
+extern volatile uint8_t chrono_down[3];    // countdown
+extern volatile __bit chrono_up_run;
+extern volatile __bit chrono_down_run;
+// countdown reached 0, set by the isr, cleared by the main loop
+extern volatile __bit chrono_expired;
+// stopwatch display frozen at chrono_lap while it keeps counting
+extern __bit chrono_lap_on;
+
+#define chrono_running() (chrono_up_run || chrono_down_run)
+
+// tick isr, only while chrono_running(): advance, returns 1 on expiry
+__bit chrono_tick();
+
+// display snapshot, lap time while frozen
+void chrono_read(__data uint8_t *t, uint8_t down);
+
+// stopwatch keys: start/stop, lap (running) or reset (stopped)
+void chrono_up_start();
+void chrono_up_lap();
+
+// countdown keys: start/stop (restarts from the preset at 0, a 0:00 preset
+// does not start), edit preset
+// (stops, loads preset), minute/second increment, store preset
+void chrono_down_start();
+void chrono_down_edit();
+void chrono_down_min_incr();
+void chrono_down_sec_incr();
+void chrono_down_set();
@@ -0,0 +1,114 @@
+// DS1302 crystal temperature compensation
+//
+
+#include "drift.h"
+#include "ds1302.h"
+#include "eeprom.h"
+#include "telemetry.h"
+
+// error since the last correction, DRIFT_SECOND units per second, the clock
+// is behind when negative
+static int32_t drift_acc;
+// +1/-1: second to add/take away on the next tick
+static int8_t drift_pending;
+static uint8_t drift_sec;
+
+uint8_t drift_field;
+
+void drift_minute(uint8_t temp) {
+    uint8_t t0 = cfg_ext[CFG_EXT_DRIFT];
+    uint8_t k = cfg_ext[CFG_EXT_DRIFT + 1];
+    int8_t aging = cfg_ext[CFG_EXT_DRIFT + 2];
+    int8_t dt;
+
+    if (t0 == 0) {
+        t0 = DRIFT_T0;
+        k = DRIFT_K;
+        aging = DRIFT_AGING;
+    }
+    if (k == 0) return;
+
+    dt = temp - t0;
+    drift_acc += aging * 100 - (int32_t)k * (uint16_t)(dt * dt);
+
+    if (drift_acc <= -DRIFT_SECOND) {
+        drift_acc += DRIFT_SECOND;
+        drift_pending++;
+    } else if (drift_acc >= DRIFT_SECOND) {
+        drift_acc -= DRIFT_SECOND;
+        drift_pending--;
+    }
+}
+
+void drift_apply() {
+    uint8_t s = rtc_table[DS_ADDR_SECONDS];
+    uint16_t n;
+
+    if (s == drift_sec) return;
+    drift_sec = s;
+    if (drift_pending == 0) return;
+
+    // writing the seconds restarts the DS1302 divider, so a write this far
+    // into the second (up to a loop, ~0.1s) would lose that much as well:
+    // wait for the next edge and write right behind it, leaving the
+    // readbyte/writebyte time (<1ms) as the error. Holds the loop up to a
+    // second once per correction; gives up if the rtc is not ticking.
+    n = 0;
+    do {
+        s = ds_readbyte(DS_ADDR_SECONDS);
+        if (!++n) return;
+    } while (s == drift_sec);
+
+    if (drift_pending > 0 && s < 0x59) {
+        s = ds_int2bcd(ds_split2int(s) + 1);
+        drift_pending--;
+        tm_report("drift", 1);
+    } else if (drift_pending < 0 && s > 0x00) {
+        s = ds_int2bcd(ds_split2int(s) - 1);
+        drift_pending++;
+        tm_report("drift", -1);
+    } else {
+        rtc_table[DS_ADDR_SECONDS] = drift_sec = s;
+        return;
+    }
+    ds_writebyte(DS_ADDR_SECONDS, s);
+    rtc_table[DS_ADDR_SECONDS] = drift_sec = s;
+}
+
+void drift_reset() {
+    drift_acc = 0;
+    drift_pending = 0;
+}
+
+void drift_field_next() {
+    if (++drift_field > DRIFT_F_AGING)
+        drift_field = DRIFT_F_T0;
+}
+
+int8_t drift_value() {
+    if (cfg_ext[CFG_EXT_DRIFT] == 0) {
+        if (drift_field == DRIFT_F_T0) return DRIFT_T0;
+        if (drift_field == DRIFT_F_K) return DRIFT_K;
+        return DRIFT_AGING;
+    }
+    return cfg_ext[CFG_EXT_DRIFT + drift_field];
+}
+
+void drift_value_incr() {
+    int8_t v;
+
+    if (cfg_ext[CFG_EXT_DRIFT] == 0) {
+        cfg_ext[CFG_EXT_DRIFT] = DRIFT_T0;
+        cfg_ext[CFG_EXT_DRIFT + 1] = DRIFT_K;
+        cfg_ext[CFG_EXT_DRIFT + 2] = DRIFT_AGING;
+    }
+    v = cfg_ext[CFG_EXT_DRIFT + drift_field] + 1;
+    if (drift_field == DRIFT_F_T0) {
+        if (v > DRIFT_T0_MAX) v = DRIFT_T0_MIN;
+    } else if (drift_field == DRIFT_F_K) {
+        if (v > DRIFT_K_MAX) v = 0;
+    } else {
+        if (v > DRIFT_AGING_MAX) v = -DRIFT_AGING_MAX;
+    }
+    cfg_ext[CFG_EXT_DRIFT + drift_field] = v;
+}
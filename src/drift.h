@@ -0,0 +1,53 @@
+// DS1302 crystal temperature compensation
+// a 32768Hz tuning fork crystal runs slow away from its turnover point,
+//   ppm = -k * (T - T0)^2 + aging
+// the expected error is integrated once a minute against the measured
+// temperature, whole seconds are then added to or taken from the DS1302
+//
+
+#include <stdint.h>
+
+// defaults for a typical crystal, used while cfg_ext holds T0 = 0 (see eeprom.h)
+#define DRIFT_T0      25    // turnover, degrees C
+#define DRIFT_K       34    // parabolic coefficient, 0.001 ppm/C^2, 0 = off
+#define DRIFT_AGING   0     // static offset, 0.1 ppm, signed
+
+// ranges set from the keys, aging +-5ppm
+#define DRIFT_T0_MIN    15
+#define DRIFT_T0_MAX    35
+#define DRIFT_K_MAX     99
+#define DRIFT_AGING_MAX 50
+
+// parameter shown/set on the drift screen, drift_field
+#define DRIFT_F_T0      0
+#define DRIFT_F_K       1
+#define DRIFT_F_AGING   2
+
+// accumulated error unit: 0.001 ppm over one minute = 60ns
+#define DRIFT_SECOND  16666667L
+
+#ifdef DRIFT_COMP
+
+// once a minute, temp in degrees C
+void drift_minute(uint8_t temp);
+
+// after ds_readburst(): applies a pending correction right after the next
+// seconds edge (waits for it), within 0..59 so minutes never carry
+void drift_apply();
+
+// time was just checked against GPS, drop the accumulated error
+void drift_reset();
+
+// drift screen: S1 selects the parameter, S2 steps it within its range
+// (wraps); the first step copies the drift.h defaults to cfg_ext
+extern uint8_t drift_field;
+void drift_field_next();
+void drift_value_incr();
+// parameter as used by drift_minute()
+int8_t drift_value();
+
+#else
+#define drift_minute(temp)
+#define drift_apply()
+#define drift_reset()
+#endif
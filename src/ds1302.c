@@ -7,28 +7,49 @@
 
 #include "ds1302.h"
 
-#define MAGIC_HI  0x5A
-#define MAGIC_LO  0xA5
+#ifdef LVD_FLUSH
+// ds_ram_writeburst is also called from the lvd isr
+#pragma nooverlay
+
+volatile __bit ds_lvd_armed;
+#endif
+
+uint8_t readbyte();
+void sendbyte(uint8_t b);
+
+// second magic byte: MAGIC_HI as the firmware before the history wrote it
+// (config only, the RAM behind it undefined), MAGIC_HIST once the history
+// area holds samples or HIST_EMPTY
+#define MAGIC_HI    0x5A
+#define MAGIC_HIST  0x5B
+#define MAGIC_LO    0xA5
+// unwritten history, HIST_EMPTY of history.h
+#define HIST_FILL   0xFF
 
 void ds_ram_config_init() {
-    uint8_t i,j;
-    // check magic bytes to see if ram has been written before
-    if ( (ds_readbyte( DS_CMD_RAM >> 1 | 0x00) != MAGIC_LO || ds_readbyte( DS_CMD_RAM >> 1 | 0x01) != MAGIC_HI) ) {
-        // if not, must init ram config to defaults
-        ds_writebyte( DS_CMD_RAM >> 1 | 0x00, MAGIC_LO);
-        ds_writebyte( DS_CMD_RAM >> 1 | 0x01, MAGIC_HI);
-
-	ds_ram_config_write();	// OPTIMISE : Will generate a ljmp to ds_ram_config_write
-	return;
+    uint8_t buf[6], i;
+    // magic and config in one burst, cut short after the config
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_READ);
+    for (i=0; i!=6; i++)
+        buf[i] = readbyte();
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+
+    // check magic bytes to see if ram has been written before, config of
+    // either layout is kept
+    if (buf[0] != MAGIC_LO || (buf[1] != MAGIC_HI && buf[1] != MAGIC_HIST)) {
+        // if not (first boot, battery lost): default config, empty history
+        ds_ram_writeburst(0, 0);
+        return;
     }
-    
-    // read ram config
-    // OPTIMISE : end condition of loop !=4 will generate less code than <4 
-    // OPTIMISE : was cfg_table[i] = ds_readbyte(DS_CMD_RAM >> 1 | (i+2));
-    //            using a second variable instead of DS_CMD_RAM>>1 | (i+2) generates less code
-    j=DS_CMD_RAM>>1|2;
+
+    // OPTIMISE : end condition of loop !=4 will generate less code than <4
     for (i=0; i!=4; i++)
-        cfg_table[i] = ds_readbyte(j++);
+        cfg_table[i] = buf[i + 2];
 }
 
 void ds_ram_config_write() {
@@ -38,6 +59,50 @@ void ds_ram_config_write() {
         ds_writebyte( j++, cfg_table[i]);
 }
 
+void ds_ram_writeburst(__idata uint8_t *buf, uint8_t len) {
+    // ds1302 burst-write ram: magic, cfg_table, then len bytes from buf,
+    // the rest of the RAM as empty history
+    uint8_t i;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_WRITE);
+    sendbyte(MAGIC_LO);
+    sendbyte(MAGIC_HIST);
+    for (i=0; i!=4; i++)
+        sendbyte(cfg_table[i]);
+    for (i=DS_RAM_HIST; i!=DS_RAM_SIZE; i++) {
+        if (len) {
+            sendbyte(*buf++);
+            len--;
+        } else {
+            sendbyte(HIST_FILL);
+        }
+    }
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+}
+
+uint8_t ds_ram_readburst(__idata uint8_t *buf, uint8_t len) {
+    // ds1302 burst-read ram: check magic, skip cfg, then len bytes into buf
+    uint8_t i, ok;
+    DS_LVD_HOLD();
+    DS_CE = 0;
+    DS_SCLK = 0;
+    DS_CE = 1;
+    sendbyte(DS_CMD | DS_CMD_RAM | DS_BURST_MODE << 1 | DS_CMD_READ);
+    ok = readbyte() == MAGIC_LO;
+    if (readbyte() != MAGIC_HIST) ok = 0;
+    for (i=0; i!=4; i++)
+        readbyte();
+    while (len--)
+        *buf++ = readbyte();
+    DS_CE = 0;
+    DS_LVD_RELEASE();
+    return ok;
+}
+
 void sendbyte(uint8_t b)
 {
   b;
@@ -46,14 +111,18 @@ void sendbyte(uint8_t b)
         mov     a,dpl
 	mov	r7,#8
 00001$:
+#ifndef DS_FASTIO
 	nop
 	nop
+#endif
         rrc     a
-        mov     _P1_1,c
-	setb	_P1_2
+        mov     DS_ASM(DS_IO),c
+	setb	DS_ASM(DS_SCLK)
+#ifndef DS_FASTIO
 	nop
 	nop
-	clr	_P1_2
+#endif
+	clr	DS_ASM(DS_SCLK)
 	djnz	r7,00001$
 	pop	ar7
   __endasm;
@@ -66,14 +135,18 @@ uint8_t readbyte()
 	mov 	a,#0
 	mov 	r7,#8
 00002$:
+#ifndef DS_FASTIO
 	nop
 	nop
-	mov	c,_P1_1
+#endif
+	mov	c,DS_ASM(DS_IO)
 	rrc	a	
-	setb	_P1_2
+	setb	DS_ASM(DS_SCLK)
+#ifndef DS_FASTIO
 	nop
 	nop
-	clr	_P1_2
+#endif
+	clr	DS_ASM(DS_SCLK)
 	djnz	r7,00002$
 	mov	dpl,a
 	pop	ar7
@@ -84,6 +157,7 @@ uint8_t ds_readbyte(uint8_t addr) {
     // ds1302 single-byte read
     uint8_t b;
     b = DS_CMD | DS_CMD_CLOCK | addr << 1 | DS_CMD_READ;
+    DS_LVD_HOLD();
     DS_CE = 0;
     DS_SCLK = 0;
     DS_CE = 1;
@@ -92,28 +166,54 @@ uint8_t ds_readbyte(uint8_t addr) {
     // read byte
     b=readbyte();
     DS_CE = 0;
+    DS_LVD_RELEASE();
     return b;
 }
 
 void ds_readburst() {
     // ds1302 burst-read 8 bytes into struct
-    uint8_t j, b;
+    uint8_t b;
     b = DS_CMD | DS_CMD_CLOCK | DS_BURST_MODE << 1 | DS_CMD_READ;
+    DS_LVD_HOLD();
     DS_CE = 0;
     DS_SCLK = 0;
     DS_CE = 1;
     // send cmd byte
     sendbyte(b);
-    // read bytes
-    for (j=0; j!=8; j++) 
-        rtc_table[j] = readbyte();
+    // read bytes, clocked in one loop instead of calling readbyte() per byte
+    // OPTIMISE : saves the lcall/ret, push/pop ar7 and indexed store of every byte
+  __asm
+	mov	r0,#_rtc_table
+	mov	r6,#8
+00003$:
+	mov	r7,#8
+00004$:
+#ifndef DS_FASTIO
+	nop
+	nop
+#endif
+	mov	c,DS_ASM(DS_IO)
+	rrc	a
+	setb	DS_ASM(DS_SCLK)
+#ifndef DS_FASTIO
+	nop
+	nop
+#endif
+	clr	DS_ASM(DS_SCLK)
+	djnz	r7,00004$
+	mov	@r0,a
+	inc	r0
+	djnz	r6,00003$
+  __endasm;
     DS_CE = 0;
+    DS_LVD_RELEASE();
 }
 
 void ds_writebyte(uint8_t addr, uint8_t data) {
     // ds1302 single-byte write
     uint8_t b = 0;
     b = DS_CMD | DS_CMD_CLOCK | addr << 1 | DS_CMD_WRITE;
+    DS_LVD_HOLD();
     DS_CE = 0;
     DS_SCLK = 0;
     DS_CE = 1;
@@ -123,13 +223,19 @@ void ds_writebyte(uint8_t addr, uint8_t data) {
     sendbyte(data);
 
     DS_CE = 0;
+    DS_LVD_RELEASE();
 }
 
 void ds_init() {
-    uint8_t b = ds_readbyte(DS_ADDR_SECONDS);
-    ds_writebyte(DS_ADDR_WP, 0); // clear WP
-    b &= ~(0b10000000);
-    ds_writebyte(DS_ADDR_SECONDS, b); // clear CH
+    // one burst fills rtc_table, WP and CH are only written when set, so a
+    // running clock is not touched (a seconds write would restart the second)
+    ds_readburst();
+    if (rtc_table[DS_ADDR_WP])
+        ds_writebyte(DS_ADDR_WP, 0); // clear WP
+    if (rtc_table[DS_ADDR_SECONDS] & 0b10000000) {
+        rtc_table[DS_ADDR_SECONDS] &= ~(0b10000000);
+        ds_writebyte(DS_ADDR_SECONDS, rtc_table[DS_ADDR_SECONDS]); // clear CH
+    }
 }
 
 // reset date, time
@@ -179,10 +285,10 @@ void ds_hours_incr() {
         hours = ds_split2int(rtc_table[DS_ADDR_HOUR]&DS_MASK_HOUR12);	//12h format
         if (hours < 12)
             hours++;
-        else {
+        else
             hours = 1;
-            H12_PM=!H12_PM;
-        }
+        if (hours == 12)
+            H12_PM=!H12_PM;	// 11 -> 12 changes AM/PM, 12 -> 1 does not
         b = (H12_PM?(DS_MASK_AMPM_MODE|DS_MASK_PM):DS_MASK_AMPM_MODE) | ds_int2bcd(hours);        
     }
     
@@ -234,6 +340,18 @@ void ds_sec_zero() {
     ds_writebyte(DS_ADDR_SECONDS,0);
 }
     
+// hours in 24h format (0-23) whatever mode the rtc is in
+uint8_t ds_hour24() {
+    uint8_t hours;
+    if (H12_24) {
+        hours = ds_split2int(rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR12);   // 1-12
+        if (hours == 12) hours = 0;
+        if (H12_PM) hours += 12;
+        return hours;
+    }
+    return ds_split2int(rtc_table[DS_ADDR_HOUR] & DS_MASK_HOUR24);
+}
+
 uint8_t ds_split2int(uint8_t tens_ones) {
     return (tens_ones>>4) * 10 + (tens_ones&0xF);
 }
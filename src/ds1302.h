@@ -7,10 +7,39 @@
 
 #define _nop_ __asm nop __endasm;
 
+// With GPS_UART2 the GPS takes UART2 on its default pins RxD2/TxD2 = P1.0/P1.1
+// (the P4.6/P4.7 alternative is not bonded out on the 28 pin 408AS), CE and IO
+// are rewired to P5.5 (J01) and P5.4, the only spare pins of that package.
+// P5.4 doubles as RST, flash with the reset pin disabled. DS1302_P5 states
+// the board has that rework, an image without it would lose the rtc.
+#if defined(GPS_UART2) && !defined(DS1302_P5)
+#error "GPS_UART2 needs the DS1302 rewired to P5.5/P5.4, add DS1302_P5 to FEATURES"
+#endif
+#ifdef DS1302_P5
+#define DS_CE    P5_5
+#define DS_IO    P5_4
+#else
 #define DS_CE    P1_0
 #define DS_IO    P1_1
+#endif
 #define DS_SCLK  P1_2
 
+// pin as asm symbol, DS_ASM(DS_IO) -> _P1_1, keeps the transfer loops on the
+// pins above
+#define DS_ASM_(pin) _##pin
+#define DS_ASM(pin)  DS_ASM_(pin)
+
+// DS1302 pins are not routed to SPI capable pins on either revision (SPI is on
+// P1.2-P1.5 / P2.1-P2.4 and collides with SCLK, SW3/LED and the segment lines),
+// so the bus is always bit-banged.
+// With DS_FASTIO the nop padding around SCLK is dropped: on the 1T core setb/clr
+// already keep SCLK high/low for 3 clocks (~270ns @ 11.0592MHz), which meets
+// tCH/tCL (250ns) and tCDD (200ns) at 5V. Default for the 408AS revision,
+// build with -DDS_SLOWIO to keep the padded timing.
+#if defined(stc15w408as) && !defined(DS_SLOWIO)
+#define DS_FASTIO
+#endif
+
 #define DS_CMD        1 << 7
 #define DS_CMD_READ   1
 #define DS_CMD_WRITE  0
@@ -82,6 +111,13 @@ __bit __at (0x35) H12_PM;
 // hour_12_24 in RTC is at address 0x26, bit 7 -> => 0x26-0x20 => 0x6*8+7 => 55 => 0x37
 __bit __at (0x37) H12_24;
 
+// DS1302 RAM layout: magic (2) / cfg_table (4) / history (25), see history.h
+
+#define DS_RAM_MAGIC  0
+#define DS_RAM_CFG    2
+#define DS_RAM_HIST   6
+#define DS_RAM_SIZE   31
+
 // config in DS1302 RAM
 
 uint8_t __at (0x2c) cfg_table[4];
@@ -89,10 +125,14 @@ uint8_t __at (0x2c) cfg_table[4];
 #define CFG_ALARM_HOURS_BYTE   0
 #define CFG_ALARM_MINUTES_BYTE 1
 #define CFG_TEMP_BYTE          2
+#define CFG_CHIME_START_BYTE   2
+#define CFG_CHIME_STOP_BYTE    3
 
 #define CFG_ALARM_HOURS_MASK   0b11111000
 #define CFG_ALARM_MINUTES_MASK 0b00111111
 #define CFG_TEMP_MASK          0b00000111
+#define CFG_CHIME_START_MASK   0b11111000
+#define CFG_CHIME_STOP_MASK    0b00011111
 
 // Offset 0 => alarm_hour (7..3) / chime_on (2) / alarm_on (1) / temp_C_F (0)
 // Offset 1 => (7) not used / (6) sw_mmdd / alarm_minute (5..0)
@@ -105,11 +145,31 @@ __bit __at (0x61) CONF_ALARM_ON;
 __bit __at (0x62) CONF_CHIME_ON;
 __bit __at (0x6E) CONF_SW_MMDD;
 
+// LVD_FLUSH: the lvd isr writes DS1302 RAM, main loop transfers mask it so
+// the isr never cuts into one (<0.2ms delay). ds_lvd_armed is cleared while a
+// flush is done and the supply not back yet
+#ifdef LVD_FLUSH
+extern volatile __bit ds_lvd_armed;
+#define DS_LVD_HOLD()     (ELVD = 0)
+#define DS_LVD_RELEASE()  (ELVD = ds_lvd_armed)
+#else
+#define DS_LVD_HOLD()
+#define DS_LVD_RELEASE()
+#endif
+
 // DS1302 Functions
 
 void ds_ram_config_init();
 void ds_ram_config_write();
 
+// ds1302 burst-write ram: magic, cfg_table, then len bytes from buf, HIST_EMPTY
+// up to the end of the RAM
+void ds_ram_writeburst(__idata uint8_t *buf, uint8_t len);
+
+// ds1302 burst-read ram: len bytes after cfg into buf, returns 0 if magic is
+// missing or from before the history (the bytes are undefined then)
+uint8_t ds_ram_readburst(__idata uint8_t *buf, uint8_t len);
+
 // ds1302 single-byte read
 uint8_t ds_readbyte(uint8_t addr);
 
@@ -119,7 +179,7 @@ void ds_readburst();
 // ds1302 single-byte write
 void ds_writebyte(uint8_t addr, uint8_t data);
 
-// clear WP, CH
+// burst read into rtc_table, clear WP, CH if set
 void ds_init();
 
 // reset date/time to 01/01 00:00
@@ -143,6 +203,9 @@ void ds_day_incr();
 void ds_weekday_incr();
 void ds_sec_zero();
     
+// hours in 24h format (0-23) from rtc_table
+uint8_t ds_hour24();
+
 // split bcd to int
 uint8_t ds_split2int(uint8_t tens_ones);
 
@@ -0,0 +1,100 @@
+// GPS receiver setup at boot
+//
+
+#include "gps.h"
+#include "nmea.h"
+#include "telemetry.h"
+
+#ifdef GPS_CONFIG
+
+#define GPS_STR_(x) #x
+#define GPS_STR(x)  GPS_STR_(x)
+#define GPS_RATE_S  GPS_STR(GPS_RATE)
+
+// fields: GLL RMC VTG GGA GSA GSV, 11 reserved, ZDA, MCHN
+__code char pmtk_output[] = "PMTK314,0," GPS_RATE_S ",0,0,0,0,0,0,0,0,0,0,0,0,0,0,0," GPS_RATE_S ",0";
+
+// NMEA class (0xF0) message id / enabled
+__code uint8_t ubx_msgs[][2] = {
+    {0x00, 0},  // GGA
+    {0x01, 0},  // GLL
+    {0x02, 0},  // GSA
+    {0x03, 0},  // GSV
+    {0x04, 1},  // RMC
+    {0x05, 0},  // VTG
+    {0x08, 1},  // ZDA
+};
+
+__code char hexdigit[] = "0123456789ABCDEF";
+
+#ifdef GPS_UART2
+// polled, uart2 isr masked so it doesn't clear S2TI first
+static void gps_putc(uint8_t c) {
+    IE2 &= ~0x01;
+    S2BUF = c;
+    while (!(S2CON & 0x02));
+    S2CON &= ~0x02;
+    IE2 |= 0x01;
+}
+#else
+// UART1 is shared with telemetry
+#define gps_putc(c) tm_putc(c)
+#endif
+
+// $body*cs\r\n
+static void gps_nmea(__code char *s) {
+    uint8_t cs = 0;
+    gps_putc('$');
+    while (*s) {
+        cs ^= *s;
+        gps_putc(*s++);
+    }
+    gps_putc('*');
+    gps_putc(hexdigit[cs >> 4]);
+    gps_putc(hexdigit[cs & 0x0F]);
+    gps_putc('\r');
+    gps_putc('\n');
+}
+
+// UBX frame, 8 bit Fletcher checksum over class, id, length and payload
+static void gps_ubx(uint8_t *frame, uint8_t len) {
+    uint8_t a = 0, b = 0;
+    gps_putc(0xB5);
+    gps_putc(0x62);
+    while (len--) {
+        a += *frame;
+        b += a;
+        gps_putc(*frame++);
+    }
+    gps_putc(a);
+    gps_putc(b);
+}
+
+void gps_configure(void) {
+    // CFG-MSG, rate on the current port
+    uint8_t frame[7] = {0x06, 0x01, 3, 0, 0xF0, 0, 0};
+    uint8_t i;
+
+    gps_nmea(pmtk_output);
+    for (i = 0; i < sizeof(ubx_msgs) / sizeof(ubx_msgs[0]); i++) {
+        frame[5] = ubx_msgs[i][0];
+        frame[6] = ubx_msgs[i][1] ? GPS_RATE : 0;
+        gps_ubx(frame, sizeof(frame));
+    }
+}
+
+void gps_report(void) {
+    uint16_t bytes, sentences, zda;
+
+    __critical {
+        bytes = nmea_bytes;
+        sentences = nmea_sentences;
+        zda = nmea_zda;
+        nmea_bytes = nmea_sentences = nmea_zda = 0;
+    }
+    tm_report("rxb", bytes / 60);
+    tm_report("nmea", sentences);
+    tm_report("zda", zda);
+}
+
+#endif
@@ -0,0 +1,71 @@
+// temperature history
+//
+
+#include "history.h"
+#include "ds1302.h"
+
+__idata uint8_t hist_table[HIST_HOURS + 1];
+uint8_t hist_min;
+uint8_t hist_max;
+
+static uint8_t last_hour = 0xFF;
+
+static void hist_minmax(uint8_t s) {
+    if (s == HIST_EMPTY) return;
+    if (hist_min == HIST_EMPTY || s < hist_min) hist_min = s;
+    if (hist_max == HIST_EMPTY || s > hist_max) hist_max = s;
+}
+
+void hist_init() {
+    uint8_t i, hour;
+    hist_min = hist_max = HIST_EMPTY;
+    if (!ds_ram_readburst(hist_table, HIST_HOURS + 1)) {
+        // ram lost or written by a firmware without history, start empty
+        for (i=0; i!=HIST_HOURS + 1; i++)
+            hist_table[i] = HIST_EMPTY;
+        return;
+    }
+    // min/max only live in iram, recover them from today's samples
+    hour = ds_hour24();
+    if (hist_table[HIST_INDEX] <= hour)
+        for (i=0; i<=hist_table[HIST_INDEX]; i++)
+            hist_minmax(hist_table[i]);
+    last_hour = hour;
+}
+
+void hist_update(uint8_t temp) {
+    uint8_t hour = ds_hour24();
+    uint8_t s = temp + HIST_TEMP_OFFSET;
+
+    if (hour != last_hour) {
+        if (hour == 0) {
+            // new day
+            hist_min = hist_max = HIST_EMPTY;
+        }
+        // mark hours missed while powered off as empty
+        if (hist_table[HIST_INDEX] < HIST_HOURS) {
+            uint8_t i = hist_table[HIST_INDEX];
+            while (1) {
+                if (++i == HIST_HOURS) i = 0;
+                if (i == hour) break;
+                hist_table[i] = HIST_EMPTY;
+            }
+        }
+        hist_table[hour] = s;
+        hist_table[HIST_INDEX] = hour;
+        last_hour = hour;
+#ifndef LVD_FLUSH
+        // with LVD_FLUSH written by the lvd isr on power loss only
+        ds_ram_writeburst(hist_table, HIST_HOURS + 1);
+#endif
+    }
+    hist_minmax(s);
+}
+
+uint8_t hist_sample(uint8_t n) {
+    uint8_t i = hist_table[HIST_INDEX];
+    if (i >= HIST_HOURS) return HIST_EMPTY;
+    i += HIST_HOURS - n;
+    if (i >= HIST_HOURS) i -= HIST_HOURS;
+    return hist_table[i];
+}
@@ -0,0 +1,69 @@
+// text messages on the 4 digit display
+//
+
+// msg_tick() runs in the tick isr, locals must not share overlay space
+// with functions of the main loop
+#pragma nooverlay
+
+#include "msg.h"
+#include "ledchar.h"
+
+static volatile uint8_t msg_div;
+static volatile uint8_t msg_steps;
+
+static __code char *msg_queue[MSG_QUEUE];
+static uint8_t msg_head, msg_tail;
+
+// current message, msg_len == 0 when not started yet
+static uint8_t msg_start;
+static uint8_t msg_len;
+
+void msg_tick() {
+    if (++msg_div == MSG_STEP) {
+        msg_div = 0;
+        msg_steps++;
+    }
+}
+
+static uint8_t msg_glyph(char c) {
+    if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    if (c < LEDCHAR_FIRST || c > LEDCHAR_LAST) c = ' ';
+    return ledchar[c - LEDCHAR_FIRST];
+}
+
+void msg_show(__code char *s) __critical {
+    if ((uint8_t)(msg_tail - msg_head) == MSG_QUEUE) return;
+    msg_queue[msg_tail & (MSG_QUEUE - 1)] = s;
+    msg_tail++;
+}
+
+uint8_t msg_render(uint8_t *buf) {
+    __code char *s;
+    uint8_t step, pos, last, i;
+
+    if (msg_head == msg_tail) return 0;
+    s = msg_queue[msg_head & (MSG_QUEUE - 1)];
+
+    if (!msg_len) {
+        while (s[msg_len]) msg_len++;
+        if (!msg_len) { msg_head++; return 0; }
+        msg_start = msg_steps;
+    }
+
+    // hold, scroll one char per step, hold, done
+    step = msg_steps - msg_start;
+    last = msg_len > 4 ? msg_len - 4 : 0;
+    pos = step < MSG_HOLD ? 0 : step - MSG_HOLD;
+    if (pos > last) {
+        if (pos >= last + MSG_HOLD) {
+            msg_len = 0;
+            msg_head++;
+            return 0;
+        }
+        pos = last;
+    }
+
+    for (i=0; i!=4; i++, pos++)
+        buf[i] = msg_glyph(pos < msg_len ? s[pos] : ' ');
+    return 1;
+}
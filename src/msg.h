@@ -0,0 +1,31 @@
+// text messages on the 4 digit display
+// strings live in code space and are mapped to glyphs through ledchar[],
+// longer than 4 characters scroll right to left
+//
+
+#include <stdint.h>
+
+#ifdef MESSAGES
+
+// pending messages, power of 2
+#define MSG_QUEUE   4
+// 10ms ticks per scroll step
+#define MSG_STEP    25
+// steps a message stays still at start and end
+#define MSG_HOLD    4
+
+// scroll clock, advanced from the 10ms timer tick isr
+void msg_tick();
+
+// queue a message, dropped when the queue is full
+void msg_show(__code char *s);
+
+// render current message frame as 4 ledtable indexes into buf,
+// returns 0 when no message is active (buf untouched)
+uint8_t msg_render(uint8_t *buf);
+
+#else
+#define msg_tick()
+#define msg_show(s)
+#define msg_render(buf) 0
+#endif
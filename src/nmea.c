@@ -0,0 +1,210 @@
+// NMEA receiver, picks GPS time/date from $GPZDA sentences
+//
+
+// called from the uart isr in main.c (tick isr with GPS_UART2), locals must not share overlay space
+// with functions of the main loop
+#pragma nooverlay
+
+#include "nmea.h"
+#include "ds1302.h"
+
+// NMEA receive state
+enum nmea_state {
+	NM_UNKNOWN,
+	NM_HEADER,
+	NM_ZDATIME,
+	NM_ZDAFRACRIONSECONDS,
+	NM_ZDADAY,
+	NM_ZDAMONTH,
+	NM_ZDAYEAR,
+	NM_ZDATZHOUR,
+	NM_ZDATZMINUTE,
+	NM_ZDACHECKSUM
+};
+static uint8_t zda_state = NM_UNKNOWN;
+static uint8_t zda_state_pos = 0;
+static uint8_t zda_checksum = 0;
+
+#define set_zda_state(s) zda_state = s; zda_state_pos = 0;
+
+volatile uint8_t gpstm_table[8];
+volatile __bit gpstm_needupdate = 0;
+
+#ifdef GPS_CONFIG
+volatile uint16_t nmea_bytes;
+volatile uint16_t nmea_sentences;
+volatile uint16_t nmea_zda;
+#endif
+
+#ifdef GPS_UART2
+static uint8_t nmea_rxq[NMEA_RXQ];
+static volatile uint8_t nmea_rx_head;
+static volatile uint8_t nmea_rx_tail;
+
+void nmea_rx_isr(uint8_t c)
+{
+	if ((uint8_t)(nmea_rx_head - nmea_rx_tail) != NMEA_RXQ)
+		nmea_rxq[nmea_rx_head++ & (NMEA_RXQ - 1)] = c;
+}
+
+void nmea_rx_tick()
+{
+	while (nmea_rx_tail != nmea_rx_head)
+		nmea_feed(nmea_rxq[nmea_rx_tail++ & (NMEA_RXQ - 1)]);
+}
+#endif
+
+void nmea_feed(uint8_t data)
+{
+#ifdef GPS_CONFIG
+	nmea_bytes++;
+	if (data == '$') nmea_sentences++;
+#endif
+	if (gpstm_needupdate == 1) {
+		//if local time still not updated with gps time 
+		return;
+	}
+	if (data == '$') {
+		set_zda_state(NM_HEADER);
+		//set to * so last * annihilate it
+		zda_checksum = '*';
+	} else if (zda_state == NM_UNKNOWN) {
+		//not in interesting state
+		return;
+	} else if (zda_state == NM_ZDACHECKSUM) {
+		uint8_t digit;
+		if (data >= '0' && data <= '9') {
+			digit = data - '0';
+		} else if (data >= 'A' && data <= 'F') {
+			digit = data - 'A' + 10;
+		} else {
+			set_zda_state(NM_UNKNOWN);
+			return;
+		}
+		if (zda_state_pos == 0) {
+			zda_checksum ^= digit << 4;
+			zda_state_pos = 1;
+		} else {
+			//completed
+			if (zda_checksum == digit) {
+				gpstm_needupdate = 1;
+			}
+			set_zda_state(NM_UNKNOWN);
+		}
+
+	} else {
+		zda_checksum ^= data;
+		if (zda_state == NM_HEADER) {
+			if (zda_state_pos == 0 && data == 'G') {
+			} else if (zda_state_pos == 1 && data == 'P') {
+			} else if (zda_state_pos == 2 && data == 'Z') {
+			} else if (zda_state_pos == 3 && data == 'D') {
+			} else if (zda_state_pos == 4 && data == 'A') {
+			} else if (zda_state_pos == 5 && data == ',') {
+#ifdef GPS_CONFIG
+				nmea_zda++;
+#endif
+				set_zda_state(NM_ZDATIME);
+				return;
+			} else {
+				set_zda_state(NM_UNKNOWN);
+				return;
+			}
+			zda_state_pos++;
+		} else if (zda_state == NM_ZDATIME) {
+			if (data == '.' && zda_state_pos == 6) {
+				set_zda_state(NM_ZDAFRACRIONSECONDS);
+				return;
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+				return;
+			} else {
+				uint8_t time_part;
+				if (zda_state_pos < 2) {
+					time_part = DS_ADDR_HOUR;
+				} else if (zda_state_pos < 4) {
+					time_part = DS_ADDR_MINUTES;
+				} else if (zda_state_pos < 6) {
+					time_part = DS_ADDR_SECONDS;
+				} else {
+					set_zda_state(NM_UNKNOWN);
+					return;
+				};
+				if ((zda_state_pos & 0x01) == 0) {
+					gpstm_table[time_part] = (data - '0') << 4;
+				} else {
+					gpstm_table[time_part] = gpstm_table[time_part] + (data - '0');
+				}
+				zda_state_pos++;
+			}
+		} else if (zda_state == NM_ZDAFRACRIONSECONDS) {
+			if (data == ',') {
+				set_zda_state(NM_ZDADAY);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			}
+		} else if (zda_state == NM_ZDADAY) {
+			if (data == ',') {
+				set_zda_state(NM_ZDAMONTH);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			} else {
+				if (zda_state_pos == 0) {
+					gpstm_table[DS_ADDR_DAY] = (data - '0') << 4;
+				} else if (zda_state_pos == 1) {
+					gpstm_table[DS_ADDR_DAY] = gpstm_table[DS_ADDR_DAY] + (data - '0');
+				} else {
+					set_zda_state(NM_UNKNOWN);
+					return;
+				}
+				zda_state_pos++;
+			}
+		} else if (zda_state == NM_ZDAMONTH) {
+			if (data == ',') {
+				set_zda_state(NM_ZDAYEAR);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			} else {
+				if (zda_state_pos == 0) {
+					gpstm_table[DS_ADDR_MONTH] = (data - '0') << 4;
+				} else if (zda_state_pos == 1) {
+					gpstm_table[DS_ADDR_MONTH] = gpstm_table[DS_ADDR_MONTH] + (data - '0');
+				} else {
+					set_zda_state(NM_UNKNOWN);
+					return;
+				}
+				zda_state_pos++;
+			}
+		} else if (zda_state == NM_ZDAYEAR) {
+			if (data == ',') {
+				set_zda_state(NM_ZDATZHOUR);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			} else {
+				if (zda_state_pos < 2) {
+					//centuries, skip
+				} else if (zda_state_pos == 2) {
+					gpstm_table[DS_ADDR_YEAR] = (data - '0') << 4;
+				} else if (zda_state_pos == 3) {
+					gpstm_table[DS_ADDR_YEAR] = gpstm_table[DS_ADDR_YEAR] + (data - '0');
+				} else {
+					set_zda_state(NM_UNKNOWN);
+					return;
+				}
+				zda_state_pos++;
+			}
+		} else if (zda_state == NM_ZDATZHOUR) {
+			if (data == ',') {
+				set_zda_state(NM_ZDATZMINUTE);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			}
+		} else if (zda_state == NM_ZDATZMINUTE) {
+			if (data == '*') {
+				set_zda_state(NM_ZDACHECKSUM);
+			} else if (data < '0' || data > '9') {
+				set_zda_state(NM_UNKNOWN);
+			}
+		}
+	}
+}
@@ -18,6 +18,11 @@ __sbit __at (0xC5) P4_5 ;
 __sbit __at (0xC6) P4_6 ;
 __sbit __at (0xC7) P4_7 ;
 
+/*  P5  */
+__sfr __at (0xC8) P5   ;
+__sbit __at (0xCC) P5_4 ;
+__sbit __at (0xCD) P5_5 ;
+
 __sfr __at 0x94 P0M0;
 __sfr __at 0x93 P0M1;
 __sfr __at 0x92 P1M0; 
@@ -43,6 +48,9 @@ __sfr __at 0xA1 BUS_SPEED;
 __sfr __at 0x9D P1ASF;
 __sfr __at 0xBA P_SW2;
 
+/*  PCON  */
+#define LVDF        0x20    // low voltage flag, also set at power on
+
 /*  IE  */
 __sbit __at 0xAE ELVD;
 __sbit __at 0xAD EADC;
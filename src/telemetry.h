@@ -0,0 +1,30 @@
+// telemetry: "name=value" lines out of the UART1 transmitter
+// bytes are queued and sent from the uart isr, so reporting doesn't wait on
+// the 9600 baud line unless the queue is full
+//
+
+#include "stc15.h"
+#include <stdint.h>
+
+#ifdef TELEMETRY
+
+// queued bytes, power of 2
+#define TM_QUEUE  16
+
+// uart isr, after TI: next byte or transmitter idle
+void tm_tx_isr();
+
+// queue one byte, waits while the queue is full
+void tm_putc(char c);
+
+void tm_puts(__code char *s);
+
+// one line "name=value\r\n", value in decimal
+void tm_report(__code char *name, int16_t value);
+
+#else
+#define tm_tx_isr()
+#define tm_putc(c)
+#define tm_puts(s)
+#define tm_report(name, value)
+#endif
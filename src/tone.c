@@ -0,0 +1,78 @@
+// buzzer tone generator
+//
+
+// tone_edge() and tone_tick() run in the pca isr, locals must not share
+// overlay space with functions of the main loop
+#pragma nooverlay
+
+#include "tone.h"
+
+#ifdef BUZZER
+
+// half period of notes C6..C8 in PCA clocks
+static __code uint16_t tone_period[15] = {
+    440, 392, 349, 330, 294, 262, 233,      // C6 - B6
+    220, 196, 175, 165, 147, 131, 117,      // C7 - B7
+    110                                     // C8
+};
+
+__code uint8_t *tone_pos;
+static uint16_t tone_half;         // half period of current note
+uint8_t  tone_ticks;
+volatile __bit tone_on;
+
+void tone_play(__code uint8_t *melody) {
+    tone_on = 0;
+    CCAPM0 = 0;                 // silent until first note
+    CCF0 = 0;
+    BUZZER_PIN = !BUZZER_ON;
+    tone_pos = melody;
+    tone_ticks = 1;             // load first note on next tick
+    tone_on = 1;
+}
+
+void tone_stop() {
+    tone_on = 0;
+    CCAPM0 = 0;
+    CCF0 = 0;
+    BUZZER_PIN = !BUZZER_ON;
+}
+
+void tone_edge() {
+    uint16_t c;
+    CCF0 = 0;
+    BUZZER_PIN = !BUZZER_PIN;
+    c = (CCAP0H << 8 | CCAP0L) + tone_half;
+    CCAP0L = c;
+    CCAP0H = c >> 8;
+}
+
+void tone_tick() {
+    uint8_t n;
+    if (!tone_on || --tone_ticks) return;
+    n = *tone_pos++;
+    if (n == TONE_END) {
+        tone_on = 0;
+        CCAPM0 = 0;
+        BUZZER_PIN = !BUZZER_ON;
+    } else {
+        tone_ticks = (n & 0x0F) * TONE_STEP;
+        n >>= 4;
+        if (n == TONE_REST) {
+            CCAPM0 = 0;
+            BUZZER_PIN = !BUZZER_ON;
+        } else {
+            // first edge half a period from now, CH read twice for a consistent CH:CL
+            uint16_t c;
+            uint8_t h;
+            do { h = CH; c = h << 8 | CL; } while (h != CH);
+            tone_half = tone_period[n - 1];
+            c += tone_half;
+            CCAP0L = c;
+            CCAP0H = c >> 8;
+            CCAPM0 = 0x49;          // ECOM0 | MAT0 | ECCF0
+        }
+    }
+}
+
+#endif
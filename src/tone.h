@@ -0,0 +1,68 @@
+// buzzer tone generator
+// PCA module 0 toggles the buzzer at half the note period, the 10ms tick
+// steps through a melody in code space. Both run from the PCA interrupt
+// (tick_isr in main.c), so playing never blocks the main loop.
+//
+
+#include "stc15.h"
+#include <stdint.h>
+
+#ifdef BUZZER
+
+// buzzer only on revision with stc15f204ea
+#ifndef stc15f204ea
+#error "BUZZER needs the stc15f204ea board, the stc15w408as has a voice chip on P1.3/P3.6/P3.7"
+#endif
+#define BUZZER_PIN P1_5
+// buzzer is switched by a pnp transistor, active low
+#define BUZZER_ON  0
+
+// PCA clocked by SYSclk/12 = 921.6kHz, free running
+#define TONE_STEP  5           // 10ms ticks per duration unit
+
+// melody byte: note (7..4) / duration in 50ms units, 1..15 (3..0)
+// melody is terminated by TONE_END
+#define NOTE(n, d) ((n) << 4 | (d))
+#define TONE_END   0
+
+#define TONE_REST  0
+#define TONE_C6    1
+#define TONE_D6    2
+#define TONE_E6    3
+#define TONE_F6    4
+#define TONE_G6    5
+#define TONE_A6    6
+#define TONE_B6    7
+#define TONE_C7    8
+#define TONE_D7    9
+#define TONE_E7    10
+#define TONE_F7    11
+#define TONE_G7    12
+#define TONE_A7    13
+#define TONE_B7    14
+#define TONE_C8    15
+
+// start playing melody, replaces the one playing
+void tone_play(__code uint8_t *melody);
+
+// silence buzzer
+void tone_stop();
+
+// player state, owned by the isr while tone_on is set
+extern __code uint8_t *tone_pos;   // next melody byte
+extern uint8_t  tone_ticks;        // 10ms ticks left of current note
+extern volatile __bit tone_on;
+
+// start a melody from the pca isr, first note on this tick's tone_tick()
+#define tone_start(m) { tone_pos = (m); tone_ticks = 1; tone_on = 1; }
+
+// melody still playing
+#define tone_busy() (tone_on)
+
+// pca isr, module 0 match: buzzer edge
+void tone_edge();
+
+// pca isr, 10ms tick: next note when the current one is over
+void tone_tick();
+
+#endif
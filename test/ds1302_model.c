@@ -0,0 +1,266 @@
+// DS1302 behavioral model on the simulated port pins
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "ds1302_model.h"
+#include "ds1302.h"
+
+// bit addresses of the pins, DS_ASM() gives them for the asm loops
+#define PIN_CE    DS_ASM(DS_CE)
+#define PIN_IO    DS_ASM(DS_IO)
+#define PIN_SCLK  DS_ASM(DS_SCLK)
+
+#define CMD_RAM    0x40
+#define CMD_READ   0x01
+#define CMD_ADDR(c) ((c) >> 1 & 0x1F)
+#define ADDR_BURST 31
+#define REG_WP     7
+#define REG_TCS    8
+
+static ds1302_model_t *model;
+
+static void violation(ds1302_model_t *m, const char *what)
+{
+	if (!m->violations++)
+		snprintf(m->violation, sizeof(m->violation), "%s (cmd %02x, byte %u)",
+		         what, m->cur.cmd, m->cur.bytes);
+}
+
+static uint8_t burst_mode(uint8_t cmd)
+{
+	return CMD_ADDR(cmd) == ADDR_BURST;
+}
+
+// bytes a transfer holds: 1, 8 for a clock burst, 31 for a ram burst
+static uint8_t transfer_size(uint8_t cmd)
+{
+	if (!burst_mode(cmd))
+		return 1;
+	return cmd & CMD_RAM ? DS_RAM_SIZE : 8;
+}
+
+// byte the chip shifts out at data byte index
+static uint8_t read_value(ds1302_model_t *m)
+{
+	uint8_t addr = CMD_ADDR(m->cmd);
+
+	if (m->cmd & CMD_RAM)
+		return m->ram[burst_mode(m->cmd) ? m->index : addr];
+	return burst_mode(m->cmd) ? m->burst[m->index] : m->reg[addr];
+}
+
+static void write_reg(ds1302_model_t *m, uint8_t addr, uint8_t v)
+{
+	if (addr == REG_WP)
+		v &= 0x80;
+	m->reg[addr] = v;
+}
+
+static void write_value(ds1302_model_t *m, uint8_t v)
+{
+	uint8_t addr = CMD_ADDR(m->cmd), i;
+
+	if (m->index >= transfer_size(m->cmd)) {
+		violation(m, "data byte past the end of the transfer");
+		return;
+	}
+	if (m->cmd & CMD_RAM) {
+		if (burst_mode(m->cmd))
+			addr = m->index;
+		if (m->reg[REG_WP] & 0x80)
+			m->wp_dropped++;
+		else
+			m->ram[addr] = v;
+	} else if (burst_mode(m->cmd)) {
+		// the 8 clock registers land together
+		m->burst[m->index] = v;
+		if (m->index == 7) {
+			if (m->reg[REG_WP] & 0x80) {
+				m->wp_dropped++;
+			} else {
+				for (i = 0; i != 8; i++)
+					write_reg(m, i, m->burst[i]);
+			}
+		}
+	} else if ((m->reg[REG_WP] & 0x80) && addr != REG_WP) {
+		m->wp_dropped++;
+	} else {
+		write_reg(m, addr, v);
+	}
+}
+
+static void command(ds1302_model_t *m)
+{
+	uint8_t addr = CMD_ADDR(m->cmd);
+
+	m->cur.cmd = m->cmd;
+	if (!(m->cmd & 0x80))
+		violation(m, "command bit 7 clear, the chip ignores it");
+	else if (!(m->cmd & CMD_RAM) && addr > REG_TCS && addr != ADDR_BURST)
+		violation(m, "no such clock register");
+	// clock burst reads come from a copy taken at the command
+	if (!(m->cmd & CMD_RAM) && burst_mode(m->cmd) && (m->cmd & CMD_READ))
+		memcpy(m->burst, m->reg, 8);
+}
+
+static void ce_edge(ds1302_model_t *m, uint8_t v)
+{
+	if (v) {
+		if (m->sclk)
+			violation(m, "CE raised with SCLK high");
+		memset(&m->cur, 0, sizeof(m->cur));
+		m->nbits = m->index = m->drive = m->cmd = m->ignore = 0;
+		m->ce_clocks = mcs51_clocks;
+		return;
+	}
+	if (m->nbits)
+		violation(m, "CE dropped within a byte");
+	else if (m->cmd && !(m->cmd & (CMD_RAM | CMD_READ)) && burst_mode(m->cmd) && m->index != 8)
+		violation(m, "clock burst write cut short, registers not written");
+	m->drive = 0;
+	m->cur.clocks = mcs51_clocks - m->ce_clocks;
+	m->last = m->cur;
+	m->transactions++;
+}
+
+static void rising(ds1302_model_t *m)
+{
+	m->cur.sclk++;
+	if (m->ignore)
+		return;
+	if (m->cmd && (m->cmd & CMD_READ)) {
+		if (!m->io_latch)
+			violation(m, "IO driven low by the MCU during a read");
+		if (++m->nbits == 8) {
+			m->nbits = 0;
+			if (++m->cur.bytes > transfer_size(m->cmd))
+				violation(m, "data byte past the end of the transfer");
+		}
+		return;
+	}
+	m->shift = m->shift >> 1 | m->io_latch << 7;
+	if (++m->nbits != 8)
+		return;
+	m->nbits = 0;
+	if (!m->cmd) {
+		m->cmd = m->shift;
+		command(m);
+		m->ignore = !(m->cmd & 0x80);
+	} else {
+		write_value(m, m->shift);
+		m->index++;
+		m->cur.bytes++;
+	}
+}
+
+// read data goes out on the falling edges, from the last command clock on
+static void falling(ds1302_model_t *m)
+{
+	if (!m->cmd || !(m->cmd & CMD_READ))
+		return;
+	if (m->index >= transfer_size(m->cmd)) {
+		m->drive = 0;
+		return;
+	}
+	m->out = read_value(m) >> m->nbits & 1;
+	m->drive = 1;
+	if (m->nbits == 7)
+		m->index++;
+}
+
+static void pin_write(uint8_t addr, uint8_t v)
+{
+	ds1302_model_t *m = model;
+
+	if (addr == PIN_CE) {
+		if (v != m->ce)
+			ce_edge(m, v);
+		m->ce = v;
+	} else if (addr == PIN_SCLK) {
+		if (m->ce && v && !m->sclk)
+			rising(m);
+		else if (m->ce && !v && m->sclk)
+			falling(m);
+		m->sclk = v;
+	} else if (addr == PIN_IO) {
+		m->io_latch = v;
+	}
+}
+
+// quasi-bidirectional port: the chip pulls the line low against the latch
+static uint8_t pin_read(uint8_t addr, uint8_t latch)
+{
+	if (addr == PIN_IO && model->ce && model->drive)
+		return latch & model->out;
+	return latch;
+}
+
+void ds1302_model_init(ds1302_model_t *m)
+{
+	memset(m, 0, sizeof(*m));
+	m->reg[0] = 0x80;
+	m->reg[2] = 0x00;
+	m->reg[3] = 0x01;
+	m->reg[4] = 0x01;
+	m->reg[5] = 0x01;
+	m->reg[REG_WP] = 0x80;
+	m->reg[REG_TCS] = 0x5C;
+	m->io_latch = 1;
+	model = m;
+	mcs51_pin_write = pin_write;
+	mcs51_pin_read = pin_read;
+}
+
+static uint8_t bcd_incr(uint8_t v)
+{
+	return (v & 0x0F) == 9 ? (v & 0xF0) + 0x10 : v + 1;
+}
+
+static uint8_t month_days(uint8_t month, uint8_t year)
+{
+	static const uint8_t days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	uint8_t m = (month >> 4) * 10 + (month & 0x0F);
+	uint8_t y = (year >> 4) * 10 + (year & 0x0F);
+	return days[m - 1] + (m == 2 && y % 4 == 0);
+}
+
+void ds1302_model_second(ds1302_model_t *m)
+{
+	uint8_t *r = m->reg, h, d;
+
+	if (r[0] & 0x80)
+		return;
+	if ((r[0] = bcd_incr(r[0])) != 0x60)
+		return;
+	r[0] = 0;
+	if ((r[1] = bcd_incr(r[1])) != 0x60)
+		return;
+	r[1] = 0;
+	if (r[2] & 0x80) {
+		// 12h: 11 -> 12 flips AM/PM, a new day starts at 12 AM
+		h = bcd_incr(r[2] & 0x1F);
+		if (h == 0x13)
+			h = 0x01;
+		if (h == 0x12)
+			r[2] ^= 0x20;
+		r[2] = (r[2] & 0xE0) | h;
+		if (h != 0x12 || (r[2] & 0x20))
+			return;
+	} else {
+		if ((r[2] = bcd_incr(r[2])) != 0x24)
+			return;
+		r[2] = 0;
+	}
+	r[5] = r[5] == 7 ? 1 : r[5] + 1;
+	d = (r[3] >> 4) * 10 + (r[3] & 0x0F);
+	if (d < month_days(r[4], r[6])) {
+		r[3] = bcd_incr(r[3]);
+		return;
+	}
+	r[3] = 0x01;
+	if ((r[4] = bcd_incr(r[4])) != 0x13)
+		return;
+	r[4] = 0x01;
+	r[6] = r[6] == 0x99 ? 0 : bcd_incr(r[6]);
+}
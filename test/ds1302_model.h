@@ -0,0 +1,56 @@
+// DS1302 behavioral model on the simulated port pins, for the host tests
+// http://datasheets.maximintegrated.com/en/ds/DS1302.pdf
+//
+// Decodes the command byte (clock/ram, address, burst, read/write) on the
+// SCLK rising edges while CE is high, shifts data out on the falling edges,
+// LSB first. Clock registers 0-7 and the trickle charger (8), 31 bytes of RAM,
+// write protect, clock halt and the 12/24h hour register. A clock burst
+// write only lands after all 8 registers, as on the chip.
+// Protocol violations are counted and the first one kept as text; every CE
+// high period is one transaction with its SCLK cycles and the asm clocks
+// (mcs51_clocks) spent while CE was high.
+//
+
+#ifndef DS1302_MODEL_H
+#define DS1302_MODEL_H
+
+#include <stdint.h>
+
+typedef struct {
+	uint8_t cmd;            // command byte, 0 if CE fell before it was complete
+	uint8_t bytes;          // data bytes after the command, complete ones
+	uint16_t sclk;          // SCLK rising edges
+	unsigned long clocks;   // asm clocks while CE was high
+} ds_transaction_t;
+
+typedef struct {
+	// registers as the chip holds them, reg[0] bit 7 = CH, reg[7] bit 7 = WP
+	uint8_t reg[9];
+	uint8_t ram[31];
+
+	// violations of the datasheet protocol
+	unsigned violations;
+	char violation[96];
+	// writes dropped while WP was set
+	unsigned wp_dropped;
+
+	// last complete transaction and a count of all
+	ds_transaction_t last;
+	unsigned transactions;
+
+	// bus state
+	uint8_t ce, sclk, io_latch;
+	uint8_t shift, nbits, cmd, index, drive, out, ignore;
+	uint8_t burst[8];
+	ds_transaction_t cur;
+	unsigned long ce_clocks;
+} ds1302_model_t;
+
+// attach to the DS_CE/DS_IO/DS_SCLK pins of ds1302.h, registers at power up:
+// clock halted and write protected, 01/01/00 00:00:00 24h, ram cleared
+void ds1302_model_init(ds1302_model_t *m);
+
+// one second of the 32kHz oscillator, no effect while CH is set
+void ds1302_model_second(ds1302_model_t *m);
+
+#endif
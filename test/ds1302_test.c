@@ -0,0 +1,272 @@
+// host test of the DS1302 driver (src/ds1302.c) against test/ds1302_model.c
+// usage: ds1302_test
+// The transfer loops are the __asm of ds1302.c run by the mcs51.c
+// interpreter, so bit order, edges and the IO turnaround are the ones the
+// firmware does. Prints one line per transaction kind: command, data bytes,
+// SCLK cycles and the asm clocks while CE was high (the C around the loops,
+// CE/SCLK setup and calls, is not counted). Exit code 1 on a failed check or
+// a protocol violation.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "ds1302.h"
+#include "ds1302_model.h"
+
+static ds1302_model_t ds;
+static int failed;
+
+#define CHECK(c) do { if (!(c)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #c); failed = 1; } } while (0)
+
+// the firmware never breaks the protocol
+static void clean(const char *what)
+{
+	if (ds.violations) {
+		printf("%s: %u violations, first: %s\n", what, ds.violations, ds.violation);
+		failed = 1;
+		ds.violations = 0;
+	}
+}
+
+static void report(const char *what, uint16_t sclk)
+{
+	printf("%-26s cmd %02x %3u bytes %4u sclk %6lu clocks\n", what, ds.last.cmd,
+	       ds.last.bytes, ds.last.sclk, ds.last.clocks);
+	CHECK(ds.last.sclk == sclk);
+	clean(what);
+}
+
+static void set_time(uint8_t sec, uint8_t min, uint8_t hour, uint8_t day, uint8_t month,
+                     uint8_t weekday, uint8_t year)
+{
+	ds.reg[0] = sec;
+	ds.reg[1] = min;
+	ds.reg[2] = hour;
+	ds.reg[3] = day;
+	ds.reg[4] = month;
+	ds.reg[5] = weekday;
+	ds.reg[6] = year;
+}
+
+static void clock_registers(void)
+{
+	uint8_t i;
+
+	// power up: halted, write protected, one second before 2100
+	set_time(0x80 | 0x58, 0x59, 0x23, 0x31, 0x12, 0x05, 0x99);
+	ds_init();
+	CHECK(ds.transactions == 3);
+	CHECK(ds.reg[DS_ADDR_WP] == 0);
+	CHECK(ds.reg[DS_ADDR_SECONDS] == 0x58);
+	CHECK(rtc_table[DS_ADDR_SECONDS] == 0x58);
+	CHECK(rtc_table[DS_ADDR_YEAR] == 0x99);
+	clean("ds_init");
+
+	// a running, writable clock is only read
+	ds.transactions = 0;
+	ds_init();
+	CHECK(ds.transactions == 1);
+	clean("ds_init again");
+
+	ds1302_model_second(&ds);
+	ds1302_model_second(&ds);
+	ds_readburst();
+	report("ds_readburst", 8 * 9);
+	for (i = 0; i != 8; i++)
+		CHECK(rtc_table[i] == ds.reg[i]);
+	CHECK(rtc_table[DS_ADDR_SECONDS] == 0x00 && rtc_table[DS_ADDR_HOUR] == 0x00);
+	CHECK(rtc_table[DS_ADDR_DAY] == 0x01 && rtc_table[DS_ADDR_MONTH] == 0x01);
+	CHECK(rtc_table[DS_ADDR_YEAR] == 0x00 && rtc_table[DS_ADDR_WEEKDAY] == 0x06);
+
+	// leap day of 2024
+	set_time(0x59, 0x59, 0x23, 0x28, 0x02, 0x03, 0x24);
+	ds1302_model_second(&ds);
+	CHECK(ds.reg[DS_ADDR_DAY] == 0x29 && ds.reg[DS_ADDR_MONTH] == 0x02);
+
+	CHECK(ds_readbyte(DS_ADDR_MINUTES) == 0x00);
+	report("ds_readbyte", 8 * 2);
+	CHECK(ds_readbyte(DS_ADDR_DAY) == 0x29);
+
+	ds_writebyte(DS_ADDR_MINUTES, 0x42);
+	report("ds_writebyte", 8 * 2);
+	CHECK(ds.reg[DS_ADDR_MINUTES] == 0x42);
+
+	// trickle charger, register 8
+	CHECK(ds_readbyte(DS_ADDR_TCSDS) == 0x5C);
+
+	// write protect: single writes dropped, WP itself still writable
+	ds_writebyte(DS_ADDR_WP, 0x80);
+	ds_writebyte(DS_ADDR_MINUTES, 0x17);
+	CHECK(ds.reg[DS_ADDR_MINUTES] == 0x42 && ds.wp_dropped == 1);
+	ds_writebyte(DS_ADDR_WP, 0x00);
+	ds_writebyte(DS_ADDR_MINUTES, 0x17);
+	CHECK(ds.reg[DS_ADDR_MINUTES] == 0x17);
+
+	// clock halt stops the count, a seconds write clears it
+	ds.reg[DS_ADDR_SECONDS] = 0x80 | 0x30;
+	ds1302_model_second(&ds);
+	CHECK(ds.reg[DS_ADDR_SECONDS] == 0xB0);
+	ds_sec_zero();
+	ds1302_model_second(&ds);
+	CHECK(ds.reg[DS_ADDR_SECONDS] == 0x01);
+	clean("clock registers");
+}
+
+static void hour_modes(void)
+{
+	// 24h 23:xx -> 12h 11 PM and back
+	set_time(0x10, 0x20, 0x23, 0x15, 0x06, 0x02, 0x25);
+	ds_readburst();
+	ds_hours_12_24_toggle();
+	CHECK(ds.reg[DS_ADDR_HOUR] == (DS_MASK_AMPM_MODE | DS_MASK_PM | 0x11));
+	ds_readburst();
+	CHECK(H12_24 && H12_PM && H12_TH);
+	CHECK(ds_hour24() == 23);
+	ds_hours_12_24_toggle();
+	CHECK(ds.reg[DS_ADDR_HOUR] == 0x23);
+
+	// 12h: 11:59:59 PM -> 12 AM of the next day, 11 AM -> 12 PM
+	set_time(0x59, 0x59, DS_MASK_AMPM_MODE | DS_MASK_PM | 0x11, 0x30, 0x06, 0x07, 0x25);
+	ds1302_model_second(&ds);
+	CHECK(ds.reg[DS_ADDR_HOUR] == (DS_MASK_AMPM_MODE | 0x12));
+	CHECK(ds.reg[DS_ADDR_DAY] == 0x01 && ds.reg[DS_ADDR_MONTH] == 0x07 && ds.reg[DS_ADDR_WEEKDAY] == 0x01);
+	set_time(0x59, 0x59, DS_MASK_AMPM_MODE | 0x11, 0x01, 0x07, 0x01, 0x25);
+	ds1302_model_second(&ds);
+	CHECK(ds.reg[DS_ADDR_HOUR] == (DS_MASK_AMPM_MODE | DS_MASK_PM | 0x12));
+	CHECK(ds.reg[DS_ADDR_DAY] == 0x01);
+
+	// 12 AM + 1 hour from the keys
+	set_time(0x00, 0x00, DS_MASK_AMPM_MODE | 0x12, 0x01, 0x07, 0x01, 0x25);
+	ds_readburst();
+	CHECK(ds_hour24() == 0);
+	ds_hours_incr();
+	CHECK(ds.reg[DS_ADDR_HOUR] == (DS_MASK_AMPM_MODE | 0x01));
+	clean("hour modes");
+}
+
+static void ram(void)
+{
+	uint8_t hist[DS_RAM_SIZE - DS_RAM_HIST], back[DS_RAM_SIZE - DS_RAM_HIST], i;
+
+	for (i = 0; i != sizeof(hist); i++)
+		hist[i] = 0x30 + i;
+	cfg_table[0] = 0x11;
+	cfg_table[1] = 0x22;
+	cfg_table[2] = 0x33;
+	cfg_table[3] = 0x44;
+	ds_ram_writeburst(hist, sizeof(hist));
+	report("ds_ram_writeburst(25)", 8 * (1 + DS_RAM_SIZE));
+	CHECK(ds.ram[DS_RAM_MAGIC] == 0xA5 && ds.ram[DS_RAM_MAGIC + 1] == 0x5B);
+	CHECK(!memcmp(&ds.ram[DS_RAM_CFG], "\x11\x22\x33\x44", 4));
+	CHECK(!memcmp(&ds.ram[DS_RAM_HIST], hist, sizeof(hist)));
+
+	memset(back, 0, sizeof(back));
+	CHECK(ds_ram_readburst(back, sizeof(back)) == 1);
+	report("ds_ram_readburst(25)", 8 * (1 + DS_RAM_SIZE));
+	CHECK(!memcmp(back, hist, sizeof(hist)));
+
+	// config from ram when the magic is there
+	memset((void *)cfg_table, 0, 4);
+	ds_ram_config_init();
+	report("ds_ram_config_init", 8 * 7);
+	CHECK(cfg_table[0] == 0x11 && cfg_table[3] == 0x44);
+
+	cfg_table[2] = 0x55;
+	ds.transactions = 0;
+	ds_ram_config_write();
+	report("ds_ram_config_write, each", 8 * 2);
+	CHECK(ds.transactions == 4 && ds.ram[DS_RAM_CFG + 2] == 0x55);
+
+	// magic of the firmware before the history: config kept, the bytes behind
+	// it are no history
+	ds.ram[DS_RAM_MAGIC + 1] = 0x5A;
+	memset((void *)cfg_table, 0, 4);
+	ds_ram_config_init();
+	CHECK(cfg_table[0] == 0x11 && cfg_table[3] == 0x44);
+	CHECK(ds_ram_readburst(back, sizeof(back)) == 0);
+
+	// no magic: defaults written back with an empty history
+	ds.ram[DS_RAM_MAGIC] = 0xFF;
+	ds_ram_config_init();
+	report("ds_ram_config_init, init", 8 * (1 + DS_RAM_SIZE));
+	CHECK(ds.ram[DS_RAM_MAGIC] == 0xA5 && ds.ram[DS_RAM_MAGIC + 1] == 0x5B);
+	for (i = DS_RAM_HIST; i != DS_RAM_SIZE; i++)
+		CHECK(ds.ram[i] == 0xFF);
+	CHECK(ds_ram_readburst(back, sizeof(back)) == 1 && back[0] == 0xFF);
+	ds.ram[DS_RAM_MAGIC + 1] = 0;
+	CHECK(ds_ram_readburst(back, sizeof(back)) == 0);
+	clean("ram");
+}
+
+// the model catches what the firmware must not do, pins driven by hand
+#define SET(pin, v) mcs51_setbit(DS_ASM(pin), v)
+
+static void byte(uint8_t b)
+{
+	uint8_t i;
+	for (i = 0; i != 8; i++, b >>= 1) {
+		SET(DS_IO, b & 1);
+		SET(DS_SCLK, 1);
+		SET(DS_SCLK, 0);
+	}
+}
+
+static void violations(void)
+{
+	SET(DS_SCLK, 1);
+	SET(DS_CE, 1);
+	SET(DS_CE, 0);
+	CHECK(ds.violations == 1 && strstr(ds.violation, "SCLK high"));
+
+	ds.violations = 0;
+	SET(DS_SCLK, 0);
+	SET(DS_CE, 1);
+	byte(0x02);
+	SET(DS_CE, 0);
+	CHECK(ds.violations == 1 && strstr(ds.violation, "bit 7"));
+
+	ds.violations = 0;
+	SET(DS_CE, 1);
+	SET(DS_IO, 0);
+	SET(DS_SCLK, 1);
+	SET(DS_SCLK, 0);
+	SET(DS_CE, 0);
+	CHECK(ds.violations == 1 && strstr(ds.violation, "within a byte"));
+
+	ds.violations = 0;
+	SET(DS_CE, 1);
+	byte(0xBE);
+	byte(0x00);
+	SET(DS_CE, 0);
+	CHECK(ds.violations == 1 && strstr(ds.violation, "burst write cut short"));
+
+	ds.violations = 0;
+	SET(DS_CE, 1);
+	byte(0x83);
+	SET(DS_IO, 0);
+	SET(DS_SCLK, 1);
+	SET(DS_SCLK, 0);
+	SET(DS_IO, 1);
+	SET(DS_CE, 0);
+	CHECK(ds.violations >= 1 && strstr(ds.violation, "during a read"));
+
+	ds.violations = 0;
+	SET(DS_CE, 1);
+	byte(0x82);
+	byte(0x12);
+	byte(0x34);
+	SET(DS_CE, 0);
+	CHECK(ds.violations == 1 && strstr(ds.violation, "past the end"));
+	ds.violations = 0;
+}
+
+int main(void)
+{
+	ds1302_model_init(&ds);
+	clock_registers();
+	hour_modes();
+	ram();
+	violations();
+	printf("ds1302: %s\n", failed ? "FAILED" : "OK");
+	return failed;
+}
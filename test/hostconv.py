@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+#
+# sdcc mcs51 sources to host C, for the tests under test/
+# usage: hostconv.py tree src build/host/inc   convert src/*.c/*.h and test/8051.h
+#        hostconv.py post < x.i > x.c          after the host preprocessor
+#
+# tree: sfr/sbit/__at declarations become macros on the simulated memory of
+# mcs51.h (mcs51_sfr[], mcs51_iram[], mcs51_bit()), the other sdcc keywords
+# are dropped. __at variables also get _name defined to their address, the
+# symbol the asm blocks use. __asm blocks become mcs51_asm() calls, one
+# MCS51_LINE() per line, preprocessor lines kept; a function with asm gets
+# its byte parameter in DPL and returns DPL, the sdcc calling convention.
+# post: bit stores, still "mcs51_bit(0x..) = x;" after preprocessing, become
+# mcs51_setbit() calls so pin writes reach the hooks of mcs51.c.
+#
+
+import os
+import re
+import sys
+
+HEX = r'\(?\s*(0x[0-9A-Fa-f]+)\s*\)?'
+
+DECLS = [
+    # __sfr __at (0x90) P1;
+    (re.compile(r'__sfr\s+__at\s*' + HEX + r'\s+(\w+)\s*;'),
+     lambda m: '#define %s mcs51_sfr[%s]\n#define _%s %s' % (m[2], m[1], m[2], m[1])),
+    # __sbit __at (0x91) P1_1; / __bit __at (0x37) H12_24;
+    (re.compile(r'(?:volatile\s+)?__s?bit\s+__at\s*' + HEX + r'\s+(\w+)\s*;'),
+     lambda m: '#define %s mcs51_bit(%s)\n#define _%s %s' % (m[2], m[1], m[2], m[1])),
+    # uint8_t __at (0x24) rtc_table[8];
+    (re.compile(r'(?:extern\s+)?(?:volatile\s+)?(\w+)\s+__at\s*' + HEX + r'\s+(\w+)\s*\[\s*(\w+)\s*\]\s*;'),
+     lambda m: '#define %s (*(%s (*)[%s])(mcs51_iram + %s))\n#define _%s %s' % (
+         m[3], m[1], m[4], m[2], m[3], m[2])),
+    # uint8_t __at (0x24) x;
+    (re.compile(r'(?:extern\s+)?(?:volatile\s+)?(\w+)\s+__at\s*' + HEX + r'\s+(\w+)\s*;'),
+     lambda m: '#define %s (*(%s *)(mcs51_iram + %s))\n#define _%s %s' % (
+         m[3], m[1], m[2], m[3], m[2])),
+]
+
+KEYWORDS = [
+    (re.compile(r'__at\s*\([^)]*\)'), ''),
+    (re.compile(r'__interrupt\s*\(?\s*\d+\s*\)?'), ''),
+    (re.compile(r'__using\s*\(?\s*\d+\s*\)?'), ''),
+    (re.compile(r'\b(__critical|__naked|__reentrant|__code|__data|__idata|__xdata|__pdata|__near|xdata)\b'), ''),
+    (re.compile(r'\b__bit\b'), '_Bool'),
+    (re.compile(r'^\s*#pragma\s+(nooverlay|callee_saves)\b.*$', re.M), ''),
+]
+
+ASM = re.compile(r'__asm(?!_)\b(.*?)__endasm\s*;', re.S)
+FUNC = re.compile(r'^(\w[\w \t*]*?)\b(\w+)\s*\(([^()]*)\)\s*\{', re.M)
+BYTE_PARAM = re.compile(r'^\s*(?:uint8_t|int8_t|char|unsigned char)\s+(\w+)\s*$')
+
+BIT_STORE = re.compile(r'mcs51_bit\s*\(\s*(0x[0-9A-Fa-f]+)\s*\)\s*=(?!=)\s*([^;]*);')
+
+
+def asm_block(m):
+    lines = []
+    for line in m[1].split('\n'):
+        line = line.split(';', 1)[0].strip()
+        if line.startswith('#'):
+            lines.append(line)
+        elif line:
+            lines.append('MCS51_LINE(%s)' % line)
+    if '\n' not in m[1]:
+        return 'mcs51_asm(%s);' % ' '.join(lines)
+    return 'mcs51_asm(\n%s\n);' % '\n'.join(lines)
+
+
+def body_end(text, start):
+    depth = 0
+    for i in range(start, len(text)):
+        depth += {'{': 1, '}': -1}.get(text[i], 0)
+        if depth == 0:
+            return i
+    raise ValueError('unbalanced braces')
+
+
+def asm_functions(text):
+    out, pos = [], 0
+    for m in FUNC.finditer(text):
+        if m.start() < pos:
+            continue
+        end = body_end(text, m.end() - 1)
+        body = text[m.end():end]
+        if 'mcs51_asm(' not in body:
+            continue
+        param = BYTE_PARAM.match(m[3])
+        ret = m[1].split()[-1] != 'void' and 'return' not in body
+        out.append(text[pos:m.end()])
+        out.append(' DPL = %s;' % param[1] if param else '')
+        out.append(body)
+        out.append(' return DPL;\n' if ret else '')
+        pos = end
+    out.append(text[pos:])
+    return ''.join(out)
+
+
+def convert(text):
+    text = ASM.sub(asm_block, text)
+    for pat, rep in DECLS:
+        text = pat.sub(rep, text)
+    for pat, rep in KEYWORDS:
+        text = pat.sub(rep, text)
+    return asm_functions(text)
+
+
+def tree(src, out):
+    os.makedirs(out, exist_ok=True)
+    names = [os.path.join(src, n) for n in sorted(os.listdir(src)) if n.endswith(('.c', '.h'))]
+    names.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '8051.h'))
+    for path in names:
+        text = convert(open(path).read())
+        if os.path.basename(path) == '8051.h':
+            text = '#include "mcs51.h"\n' + text
+        with open(os.path.join(out, os.path.basename(path)), 'w') as f:
+            f.write(text)
+
+
+def post(text):
+    return BIT_STORE.sub(lambda m: 'mcs51_setbit(%s, %s);' % (m[1], m[2]), text)
+
+
+def main():
+    args = sys.argv[1:]
+    if args[:1] == ['tree'] and len(args) == 3:
+        tree(args[1], args[2])
+    elif args == ['post']:
+        sys.stdout.write(post(sys.stdin.read()))
+    else:
+        sys.exit('usage: hostconv.py tree src out | post')
+
+
+main()
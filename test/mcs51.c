@@ -0,0 +1,252 @@
+// simulated mcs51 memory and asm interpreter
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mcs51.h"
+
+// reset values: SP 07h, ports high
+volatile uint8_t mcs51_iram[256];
+volatile uint8_t mcs51_sfr[256] = {
+	[0x80] = 0xFF, [0x81] = 0x07, [0x90] = 0xFF, [0xA0] = 0xFF, [0xB0] = 0xFF,
+	[0xC0] = 0xFF, [0xC8] = 0xFF,
+};
+
+void (*mcs51_pin_write)(uint8_t addr, uint8_t v);
+uint8_t (*mcs51_pin_read)(uint8_t addr, uint8_t latch);
+unsigned long mcs51_clocks;
+
+#define ACC  0xE0
+#define PSW  0xD0
+#define SP   0x81
+#define CY   0xD7
+
+static volatile uint8_t *bit_byte(uint8_t addr)
+{
+	return addr < 0x80 ? &mcs51_iram[0x20 + (addr >> 3)] : &mcs51_sfr[addr & 0xF8];
+}
+
+uint8_t mcs51_bit(uint8_t addr)
+{
+	uint8_t v = *bit_byte(addr) >> (addr & 7) & 1;
+	return addr >= 0x80 && mcs51_pin_read ? mcs51_pin_read(addr, v) : v;
+}
+
+void mcs51_setbit(uint8_t addr, uint8_t v)
+{
+	volatile uint8_t *b = bit_byte(addr);
+	if (v)
+		*b |= 1 << (addr & 7);
+	else
+		*b &= ~(1 << (addr & 7));
+	if (addr >= 0x80 && mcs51_pin_write)
+		mcs51_pin_write(addr, v != 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// STC-Y5 clocks, same keys as tools/isrcycles.py: a, c, r (Rn), i (@Ri),
+// n (#immediate), d (direct/bit), l (label)
+static const struct {
+	const char *key;
+	uint8_t clocks;
+} timing[] = {
+	{ "nop", 1 }, { "push d", 3 }, { "pop d", 2 },
+	{ "mov a,d", 2 }, { "mov a,r", 1 }, { "mov a,i", 2 }, { "mov a,n", 2 },
+	{ "mov d,a", 2 }, { "mov d,n", 3 }, { "mov r,a", 1 }, { "mov r,n", 2 },
+	{ "mov i,a", 2 }, { "mov c,d", 2 }, { "mov d,c", 3 },
+	{ "inc a", 1 }, { "inc r", 2 }, { "dec r", 2 },
+	{ "rrc a", 1 }, { "rlc a", 1 }, { "clr a", 1 },
+	{ "setb d", 3 }, { "clr d", 3 }, { "setb c", 1 }, { "clr c", 1 },
+	{ "djnz r,l", 4 }, { "sjmp l", 3 },
+};
+
+#define LINES 64
+
+static void fail(const char *what, const char *line)
+{
+	fprintf(stderr, "mcs51_asm: %s: %s\n", what, line);
+	abort();
+}
+
+static char kind(const char *op)
+{
+	if (!strcmp(op, "a"))
+		return 'a';
+	if (!strcmp(op, "c"))
+		return 'c';
+	if (op[0] == '#')
+		return 'n';
+	if (op[0] == '@')
+		return 'i';
+	if (op[0] == 'r' && op[1] >= '0' && op[1] <= '7' && !op[2])
+		return 'r';
+	if (op[strlen(op) - 1] == '$')
+		return 'l';
+	return 'd';
+}
+
+// register Rn of the selected bank
+static volatile uint8_t *reg(const char *op)
+{
+	return &mcs51_iram[(mcs51_sfr[PSW] & 0x18) + (op[op[0] == '@' ? 2 : 1] - '0')];
+}
+
+// direct address: number, (number), sfr name, arN
+static uint8_t direct(const char *op, const char *line)
+{
+	static const struct { const char *name; uint8_t addr; } names[] = {
+		{ "acc", ACC }, { "b", 0xF0 }, { "psw", PSW }, { "sp", SP },
+		{ "dpl", 0x82 }, { "dph", 0x83 },
+	};
+	char *end;
+	unsigned i;
+	long v;
+
+	if (op[0] == 'a' && op[1] == 'r' && op[2] >= '0' && op[2] <= '7' && !op[3])
+		return (mcs51_sfr[PSW] & 0x18) + op[2] - '0';
+	for (i = 0; i != sizeof(names) / sizeof(names[0]); i++)
+		if (!strcmp(op, names[i].name))
+			return names[i].addr;
+	v = strtol(op + (op[0] == '(' || op[0] == '#'), &end, 0);
+	if (end == op || (*end && *end != ')') || v < 0 || v > 255)
+		fail("unknown operand", line);
+	return v;
+}
+
+static uint8_t get(uint8_t addr)
+{
+	return addr < 0x80 ? mcs51_iram[addr] : mcs51_sfr[addr];
+}
+
+static void put(uint8_t addr, uint8_t v)
+{
+	if (addr < 0x80)
+		mcs51_iram[addr] = v;
+	else
+		mcs51_sfr[addr] = v;
+}
+
+// value of a byte operand
+static uint8_t load(const char *op, const char *line)
+{
+	switch (kind(op)) {
+	case 'a': return mcs51_sfr[ACC];
+	case 'n': return direct(op, line);
+	case 'r': return *reg(op);
+	case 'i': return mcs51_iram[*reg(op)];
+	default: return get(direct(op, line));
+	}
+}
+
+static void store(const char *op, uint8_t v, const char *line)
+{
+	switch (kind(op)) {
+	case 'a': mcs51_sfr[ACC] = v; break;
+	case 'r': *reg(op) = v; break;
+	case 'i': mcs51_iram[*reg(op)] = v; break;
+	case 'd': put(direct(op, line), v); break;
+	default: fail("not writable", line);
+	}
+}
+
+void mcs51_asm(const char *text)
+{
+	char lines[LINES][64], op[3][32], key[16];
+	int n = 0, pc, i, k;
+
+	// one instruction or label per line, spaces from the stringizing dropped
+	while (*text) {
+		const char *e = strchr(text, '\n');
+		int len = e ? e - text : (int)strlen(text), j = 0;
+		if (n == LINES)
+			fail("too long", text);
+		for (i = 0; i != len && j != 63; i++)
+			if (text[i] != ' ' || (j && lines[n][j - 1] != ' ' && lines[n][j - 1] != ','))
+				lines[n][j++] = text[i];
+		while (j && lines[n][j - 1] == ' ')
+			j--;
+		lines[n][j] = 0;
+		if (j)
+			n++;
+		text += len + (e != 0);
+	}
+
+	for (pc = 0; pc != n; pc++) {
+		char *line = lines[pc], *mn, *args;
+		int ops = 0;
+		uint8_t v, c;
+
+		if (line[strlen(line) - 1] == ':')
+			continue;
+		mn = line;
+		args = strchr(line, ' ');
+		memset(op, 0, sizeof(op));
+		if (args) {
+			char *s = args + 1, *t;
+			while (s && ops != 3) {
+				t = strchr(s, ',');
+				snprintf(op[ops++], sizeof(op[0]), "%.*s", t ? (int)(t - s) : (int)strlen(s), s);
+				s = t ? t + 1 : 0;
+			}
+		}
+		snprintf(key, sizeof(key), "%.*s", args ? (int)(args - mn) : (int)strlen(mn), mn);
+		for (i = 0; i != ops; i++) {
+			k = strlen(key);
+			snprintf(key + k, sizeof(key) - k, "%s%c", i ? "," : " ", kind(op[i]));
+		}
+		for (i = 0; i != sizeof(timing) / sizeof(timing[0]); i++)
+			if (!strcmp(timing[i].key, key))
+				break;
+		if (i == sizeof(timing) / sizeof(timing[0]))
+			fail("not simulated", line);
+		mcs51_clocks += timing[i].clocks;
+
+		if (!strcmp(key, "nop")) {
+		} else if (!strcmp(key, "push d")) {
+			mcs51_sfr[SP]++;
+			mcs51_iram[mcs51_sfr[SP]] = get(direct(op[0], line));
+		} else if (!strcmp(key, "pop d")) {
+			put(direct(op[0], line), mcs51_iram[mcs51_sfr[SP]]);
+			mcs51_sfr[SP]--;
+		} else if (!strcmp(key, "mov c,d")) {
+			mcs51_setbit(CY, mcs51_bit(direct(op[1], line)));
+		} else if (!strcmp(key, "mov d,c")) {
+			mcs51_setbit(direct(op[0], line), mcs51_bit(CY));
+		} else if (!strncmp(key, "mov ", 4)) {
+			store(op[0], load(op[1], line), line);
+		} else if (!strcmp(key, "inc a") || !strcmp(key, "inc r")) {
+			store(op[0], load(op[0], line) + 1, line);
+		} else if (!strcmp(key, "dec r")) {
+			store(op[0], load(op[0], line) - 1, line);
+		} else if (!strcmp(key, "rrc a") || !strcmp(key, "rlc a")) {
+			v = mcs51_sfr[ACC];
+			c = mcs51_bit(CY);
+			if (key[1] == 'r') {
+				mcs51_setbit(CY, v & 1);
+				mcs51_sfr[ACC] = v >> 1 | c << 7;
+			} else {
+				mcs51_setbit(CY, v >> 7);
+				mcs51_sfr[ACC] = v << 1 | c;
+			}
+		} else if (!strcmp(key, "clr a")) {
+			mcs51_sfr[ACC] = 0;
+		} else if (!strcmp(key, "setb d") || !strcmp(key, "clr d")) {
+			mcs51_setbit(direct(op[0], line), key[0] == 's');
+		} else if (!strcmp(key, "setb c") || !strcmp(key, "clr c")) {
+			mcs51_setbit(CY, key[0] == 's');
+		} else {
+			// djnz r,l / sjmp l
+			const char *label = op[ops - 1];
+			if (key[0] == 'd' && !(--*reg(op[0])))
+				continue;
+			for (i = 0; i != n; i++)
+				if (!strncmp(lines[i], label, strlen(label)) && lines[i][strlen(label)] == ':')
+					break;
+			if (i == n)
+				fail("no label", line);
+			pc = i;
+		}
+	}
+}
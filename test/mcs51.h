@@ -0,0 +1,37 @@
+// simulated mcs51 memory for the host build of the firmware sources
+// hostconv.py maps sfr/sbit/__at declarations onto these
+//
+
+#ifndef MCS51_H
+#define MCS51_H
+
+#include <stdint.h>
+
+// internal ram and sfr space, both indexed by 8051 address
+extern volatile uint8_t mcs51_iram[256];
+extern volatile uint8_t mcs51_sfr[256];
+
+// bit address space: 0x00-0x7f in iram 0x20-0x2f, 0x80-0xff in the sfrs
+// at multiples of 8
+uint8_t mcs51_bit(uint8_t addr);
+void mcs51_setbit(uint8_t addr, uint8_t v);
+
+// pin symbols pasted as _##pin (DS_ASM) from a converted sbit are its bit
+// address, in C and in the asm text
+#define _mcs51_bit(addr) (addr)
+
+// device model on the port pins: every bit write of the sfr space is passed
+// on, reads of a port bit return what the pin shows for the latch value
+extern void (*mcs51_pin_write)(uint8_t addr, uint8_t v);
+extern uint8_t (*mcs51_pin_read)(uint8_t addr, uint8_t latch);
+
+// __asm blocks run on a small interpreter: hostconv.py turns every line into
+// MCS51_LINE(), macros in it expanded (symbols of __at variables are their
+// address). Only the instructions the transfer loops use are known, anything
+// else aborts. Clocks are STC-Y5 as in tools/isrcycles.py.
+#define MCS51_LINE(...)  MCS51_STR(__VA_ARGS__)
+#define MCS51_STR(...)   #__VA_ARGS__ "\n"
+void mcs51_asm(const char *text);
+extern unsigned long mcs51_clocks;
+
+#endif
@@ -0,0 +1,218 @@
+// fuzz target for the NMEA parser (src/nmea.c)
+// libFuzzer: built with -DNMEA_LIBFUZZER -fsanitize=fuzzer (make fuzz-nmea)
+// AFL/plain: nmea_fuzz file...   inputs from files (afl-fuzz ... @@) or stdin
+//            nmea_fuzz -n count seed file...   random mutations of the files
+//
+// Each byte goes through nmea_feed() and a reference reading of the ZDA
+// grammar the parser implements; they have to agree on every accepted
+// sentence and on the fields it carried. Anything else aborts.
+//   $GPZDA,hhmmss.[f*],[d[d]],[m[m]],[yy[y[y]]],[digits],[digits]*HH
+// HH is the upper case hex xor of the characters between '$' and '*'. A
+// field with fewer digits than shown leaves older digits in gpstm_table,
+// those are not compared. gpstm_table only ever holds BCD digits.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nmea.h"
+#include "ds1302.h"
+
+// fraction and zone fields take any number of digits, a sentence longer
+// than this is not checked
+#define SENTENCE_MAX 4096
+#define SENTENCE_NONE -1
+#define SENTENCE_LONG -2
+
+static char sentence[SENTENCE_MAX + 1];
+static int sentence_len = SENTENCE_NONE;
+
+static int digits(const char *s, int n)
+{
+	while (n--)
+		if (*s < '0' || *s++ > '9')
+			return 0;
+	return 1;
+}
+
+static int hex(char c)
+{
+	return c >= '0' && c <= '9' ? c - '0' : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+// field n (0: after "GPZDA,") and its length, the last one ends at '*'
+static const char *field(const char *s, int n, int *len)
+{
+	while (n--)
+		s = strchr(s, ',') + 1;
+	*len = strcspn(s, ",*");
+	return s;
+}
+
+static uint8_t bcd(const char *s)
+{
+	return (s[0] - '0') << 4 | (s[1] - '0');
+}
+
+// sentence complete, the parser accepted it or not
+static int reference(const char *s, int len)
+{
+	const char *star = memchr(s, '*', len), *f;
+	uint8_t sum = 0;
+	int i, n, commas = 0;
+
+	if (len < 2 || !star || star + 3 != s + len || strncmp(s, "GPZDA,", 6) || memchr(s, 0, len))
+		return 0;
+	for (i = 0; s + i != star; i++) {
+		if (s[i] == ',')
+			commas++;
+		sum ^= s[i];
+	}
+	if (commas != 6 || hex(star[1]) < 0 || hex(star[2]) < 0 || sum != (hex(star[1]) << 4 | hex(star[2])))
+		return 0;
+	f = field(s + 6, 0, &n);
+	if (n < 7 || !digits(f, 6) || f[6] != '.' || !digits(f + 7, n - 7))
+		return 0;
+	if (f = field(s + 6, 1, &n), n > 2 || !digits(f, n))
+		return 0;
+	if (f = field(s + 6, 2, &n), n > 2 || !digits(f, n))
+		return 0;
+	if (f = field(s + 6, 3, &n), n > 4 || !digits(f, n))
+		return 0;
+	if (f = field(s + 6, 4, &n), !digits(f, n))
+		return 0;
+	if (f = field(s + 6, 5, &n), !digits(f, n))
+		return 0;
+	return 1;
+}
+
+static void compare(const char *s)
+{
+	const char *f;
+	int n;
+
+	f = field(s + 6, 0, &n);
+	if (gpstm_table[DS_ADDR_HOUR] != bcd(f) || gpstm_table[DS_ADDR_MINUTES] != bcd(f + 2)
+	    || gpstm_table[DS_ADDR_SECONDS] != bcd(f + 4))
+		abort();
+	if ((f = field(s + 6, 1, &n), n == 2) && gpstm_table[DS_ADDR_DAY] != bcd(f))
+		abort();
+	if ((f = field(s + 6, 2, &n), n == 2) && gpstm_table[DS_ADDR_MONTH] != bcd(f))
+		abort();
+	if ((f = field(s + 6, 3, &n), n == 4) && gpstm_table[DS_ADDR_YEAR] != bcd(f + 2))
+		abort();
+}
+
+static void feed(uint8_t c)
+{
+	uint8_t i;
+
+	nmea_feed(c);
+	if (c == '$') {
+		sentence_len = 0;
+	} else if (sentence_len >= 0) {
+		if (sentence_len == SENTENCE_MAX) {
+			sentence_len = SENTENCE_LONG;
+		} else {
+			sentence[sentence_len++] = c;
+			sentence[sentence_len] = 0;
+			// the second checksum digit ends a candidate
+			if (sentence_len >= 3 && sentence[sentence_len - 3] == '*' && !gpstm_needupdate
+			    && reference(sentence, sentence_len))
+				abort();
+		}
+	}
+	if (gpstm_needupdate) {
+		if (sentence_len != SENTENCE_LONG) {
+			if (sentence_len < 0 || !reference(sentence, sentence_len))
+				abort();
+			compare(sentence);
+		}
+		gpstm_needupdate = 0;
+		sentence_len = SENTENCE_NONE;
+	}
+	for (i = 0; i != 8; i++)
+		if ((gpstm_table[i] & 0x0F) > 9 || gpstm_table[i] >> 4 > 9)
+			abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	// any parser state ends on a line end
+	feed('\n');
+	sentence_len = SENTENCE_NONE;
+	while (size--)
+		feed(*data++);
+	return 0;
+}
+
+#ifndef NMEA_LIBFUZZER
+
+static uint8_t buf[65536];
+
+static size_t load(FILE *f)
+{
+	return fread(buf, 1, sizeof(buf), f);
+}
+
+// bit flips, byte changes, cuts and repeats of a random slice
+static size_t mutate(uint8_t *d, size_t n)
+{
+	size_t a = rand() % (n + 1), b = a + rand() % (n - a + 1);
+	int k;
+
+	for (k = rand() % 4; k >= 0; k--) {
+		switch (rand() % 5) {
+		case 0: if (n) d[rand() % n] ^= 1 << (rand() % 8); break;
+		case 1: if (n) d[rand() % n] = "$*,.0123456789ABCDEFGPZ\r\n"[rand() % 25]; break;
+		case 2: if (n) d[rand() % n] = rand(); break;
+		case 3: memmove(d + a, d + b, n - b); n -= b - a; break;
+		case 4: if (n + (b - a) <= sizeof(buf)) { memmove(d + b + (b - a), d + b, n - b); memcpy(d + b, d + a, b - a); n += b - a; } break;
+		}
+		a = rand() % (n + 1);
+		b = a + rand() % (n - a + 1);
+	}
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t corpus[16][4096];
+	size_t sizes[16], n;
+	unsigned long count = 0, i;
+	int files = 0, first = 1;
+	FILE *f;
+
+	if (argc > 3 && !strcmp(argv[1], "-n")) {
+		count = strtoul(argv[2], 0, 0);
+		srand(atoi(argv[3]));
+		first = 4;
+	}
+	if (first == argc) {
+		LLVMFuzzerTestOneInput(buf, load(stdin));
+		return 0;
+	}
+	for (i = first; i != argc && files != 16; i++) {
+		if (!(f = fopen(argv[i], "rb"))) {
+			perror(argv[i]);
+			return 2;
+		}
+		n = load(f);
+		fclose(f);
+		LLVMFuzzerTestOneInput(buf, n);
+		if (n > sizeof(corpus[0]))
+			n = sizeof(corpus[0]);
+		memcpy(corpus[files], buf, n);
+		sizes[files++] = n;
+	}
+	for (i = 0; i != count; i++) {
+		int c = rand() % files;
+		memcpy(buf, corpus[c], sizes[c]);
+		LLVMFuzzerTestOneInput(buf, mutate(buf, sizes[c]));
+	}
+	if (count)
+		printf("nmea_fuzz: %lu mutated inputs, parser and reference agree\n", count);
+	return 0;
+}
+
+#endif
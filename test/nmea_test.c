@@ -0,0 +1,105 @@
+// host replay of the NMEA parser (src/nmea.c)
+// usage: nmea_test file.nmea...          replay, compare with file.expect
+//        nmea_test -b seconds file.nmea  parser throughput
+// Every time a sentence is accepted the time is printed as
+// "YY-MM-DD hh:mm:ss" and gpstm_needupdate is cleared right away, as the
+// main loop would before the next sentence; the receive counters follow as
+// "bytes= sentences= zda=". test/nmea/ holds the corpus.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nmea.h"
+#include "ds1302.h"
+
+static uint8_t buf[65536];
+
+static size_t load(const char *name)
+{
+	FILE *f = fopen(name, "rb");
+	size_t n;
+
+	if (!f) {
+		perror(name);
+		exit(2);
+	}
+	n = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+	return n;
+}
+
+static void replay(size_t n, FILE *out)
+{
+	size_t i;
+
+	// any state ends on a line end
+	nmea_feed('\n');
+	nmea_bytes = nmea_sentences = nmea_zda = 0;
+	for (i = 0; i != n; i++) {
+		nmea_feed(buf[i]);
+		if (gpstm_needupdate) {
+			fprintf(out, "%02x-%02x-%02x %02x:%02x:%02x\n",
+			        gpstm_table[DS_ADDR_YEAR], gpstm_table[DS_ADDR_MONTH],
+			        gpstm_table[DS_ADDR_DAY], gpstm_table[DS_ADDR_HOUR],
+			        gpstm_table[DS_ADDR_MINUTES], gpstm_table[DS_ADDR_SECONDS]);
+			gpstm_needupdate = 0;
+		}
+	}
+	fprintf(out, "bytes=%u sentences=%u zda=%u\n", nmea_bytes, nmea_sentences, nmea_zda);
+}
+
+static int check(const char *name)
+{
+	char expect[256], got[4096], want[4096];
+	FILE *out = fmemopen(got, sizeof(got), "w");
+	size_t n = load(name), len;
+	int ok;
+
+	replay(n, out);
+	fclose(out);
+
+	snprintf(expect, sizeof(expect), "%.*s.expect", (int)(strrchr(name, '.') - name), name);
+	len = load(expect);
+	memcpy(want, buf, len < sizeof(want) - 1 ? len : sizeof(want) - 1);
+	want[len < sizeof(want) - 1 ? len : sizeof(want) - 1] = 0;
+
+	ok = !strcmp(got, want);
+	printf("%-28s %5zu bytes  %s\n", name, n, ok ? "OK" : "FAILED");
+	if (!ok)
+		printf("got:\n%swant:\n%s", got, want);
+	return ok;
+}
+
+static void bench(double seconds, const char *name)
+{
+	size_t n = load(name), total = 0;
+	FILE *null = fopen("/dev/null", "w");
+	clock_t start = clock(), t;
+
+	do {
+		replay(n, null);
+		total += n;
+		t = clock() - start;
+	} while (t < seconds * CLOCKS_PER_SEC);
+	fclose(null);
+	printf("%s: %.1f Mbyte/s on the host\n", name, total / ((double)t / CLOCKS_PER_SEC) / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+	int i, failed = 0;
+
+	if (argc == 4 && !strcmp(argv[1], "-b")) {
+		bench(atof(argv[2]), argv[3]);
+		return 0;
+	}
+	if (argc < 2) {
+		fprintf(stderr, "usage: nmea_test file.nmea... | -b seconds file.nmea\n");
+		return 2;
+	}
+	for (i = 1; i != argc; i++)
+		failed |= !check(argv[i]);
+	return failed;
+}
@@ -0,0 +1,100 @@
+// host test of the timezone rule engine (src/tz.c)
+// usage: tz_test rule from to            UTC instants where the offset changes
+//        tz_test rule from to n seed     offsets at n random instants
+//        tz_test select                  rules tz_select_next() steps through
+// rule is a TZ_RULE_x name of tz.h without the prefix, years 2000-2099.
+// Lines are "YYYY-MM-DD HH:MM offset" (UTC, offset in minutes), tzcheck.py
+// compares them with the system tzdata. Random instants jump back and forth,
+// so every lookup rebuilds the cached window.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tz.h"
+#include "eeprom.h"
+
+uint8_t cfg_ext[CFG_EXT_SIZE];
+
+static const struct {
+	const char *name;
+	int8_t rule[TZ_RULE_SIZE];
+} rules[] = {
+	{ "MSK", { TZ_RULE_MSK } },
+	{ "CET", { TZ_RULE_CET } },
+	{ "UK", { TZ_RULE_UK } },
+	{ "EST", { TZ_RULE_EST } },
+	{ "PST", { TZ_RULE_PST } },
+	{ "AEST", { TZ_RULE_AEST } },
+};
+
+static int mdays(int y, int m)
+{
+	return month_days[m - 1] + (m == 2 && y % 4 == 0);
+}
+
+static int16_t offset(int y, int m, int d, int minute)
+{
+	return tz_bias(y - 2000, tz_days(y - 2000, m, d), minute);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned r, i;
+	int from, to, y, m, d, minute, last = 0x7FFF;
+
+	if (argc == 2 && !strcmp(argv[1], "select")) {
+		// from a rule that is no preset, twice around
+		memset(cfg_ext, 0x55, sizeof(cfg_ext));
+		for (i = 0; i != 2 * sizeof(rules) / sizeof(rules[0]); i++) {
+			tz_select_next();
+			for (r = 0; r != sizeof(rules) / sizeof(rules[0]); r++)
+				if (!memcmp(&cfg_ext[CFG_EXT_TZ], rules[r].rule, TZ_RULE_SIZE))
+					break;
+			printf("%s\n", r == sizeof(rules) / sizeof(rules[0]) ? "?" : rules[r].name);
+		}
+		return 0;
+	}
+	if (argc != 4 && argc != 6) {
+		fprintf(stderr, "usage: tz_test rule from to [n seed] | select\n");
+		return 2;
+	}
+	for (r = 0; r != sizeof(rules) / sizeof(rules[0]); r++)
+		if (!strcmp(rules[r].name, argv[1]))
+			break;
+	if (r == sizeof(rules) / sizeof(rules[0])) {
+		fprintf(stderr, "unknown rule %s\n", argv[1]);
+		return 2;
+	}
+	for (i = 0; i != TZ_RULE_SIZE; i++)
+		cfg_ext[CFG_EXT_TZ + i] = rules[r].rule[i];
+	from = atoi(argv[2]);
+	to = atoi(argv[3]);
+
+	if (argc == 6) {
+		unsigned n = atoi(argv[4]);
+		srand(atoi(argv[5]));
+		for (i = 0; i != n; i++) {
+			y = from + rand() % (to - from + 1);
+			m = 1 + rand() % 12;
+			d = 1 + rand() % mdays(y, m);
+			minute = rand() % 1440;
+			printf("%04d-%02d-%02d %02d:%02d %d\n", y, m, d, minute / 60, minute % 60,
+			       offset(y, m, d, minute));
+		}
+		return 0;
+	}
+
+	// all rules switch on a quarter hour
+	for (y = from; y <= to; y++)
+		for (m = 1; m <= 12; m++)
+			for (d = 1; d <= mdays(y, m); d++)
+				for (minute = 0; minute < 1440; minute += 15) {
+					int16_t o = offset(y, m, d, minute);
+					if (o != last)
+						printf("%04d-%02d-%02d %02d:%02d %d\n", y, m, d,
+						       minute / 60, minute % 60, o);
+					last = o;
+				}
+	return 0;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#
+# checks the tz rule presets of src/tz.h against the system tzdata
+# usage: tzcheck.py build/host/tz_test [to-year]
+#
+# per rule: every offset change tz_test finds from the year the rule took
+# effect in that zone to to-year (default 2099), then offsets at random
+# instants, and the preset order of tz_select_next(). tzdata past 2037
+# comes from the zone's POSIX rule, which is what the presets encode.
+#
+
+import subprocess
+import sys
+from datetime import datetime, timedelta, timezone
+from zoneinfo import ZoneInfo
+
+# preset: zone, first year the zone follows the preset
+RULES = [
+    ('MSK', 'Europe/Moscow', 2015),
+    ('CET', 'Europe/Berlin', 2000),
+    ('UK', 'Europe/London', 2000),
+    ('EST', 'America/New_York', 2007),
+    ('PST', 'America/Los_Angeles', 2007),
+    ('AEST', 'Australia/Sydney', 2008),
+]
+RANDOM = 5000
+STEP = timedelta(minutes=15)
+
+
+def offset(zone, t):
+    return int(t.astimezone(zone).utcoffset().total_seconds()) // 60
+
+
+def fmt(t, o):
+    return '%s %d' % (t.strftime('%Y-%m-%d %H:%M'), o)
+
+
+def transitions(zone, first, last):
+    t = datetime(first, 1, 1, tzinfo=timezone.utc)
+    end = datetime(last + 1, 1, 1, tzinfo=timezone.utc)
+    cur = offset(zone, t)
+    out = [fmt(t, cur)]
+    day = timedelta(days=1)
+    while t < end:
+        n = t + day
+        if n < end and offset(zone, n) != cur:
+            # quarter hours of the day before
+            while offset(zone, t) == cur:
+                t += STEP
+            cur = offset(zone, t)
+            out.append(fmt(t, cur))
+        t = n
+    return out
+
+
+def tz_test(binary, *args):
+    r = subprocess.run([binary] + [str(a) for a in args], capture_output=True, text=True, check=True)
+    return r.stdout.split('\n')[:-1]
+
+
+def main():
+    binary = sys.argv[1]
+    last = int(sys.argv[2]) if len(sys.argv) > 2 else 2099
+    failed = False
+    for name, zname, first in RULES:
+        zone = ZoneInfo(zname)
+        got = tz_test(binary, name, first, last)
+        want = transitions(zone, first, last)
+        bad = [(g, w) for g, w in zip(got, want) if g != w]
+        if len(got) != len(want):
+            bad.append(('%d lines' % len(got), '%d lines' % len(want)))
+
+        wrong = []
+        for line in tz_test(binary, name, first, last, RANDOM, first):
+            date, hm, o = line.split()
+            t = datetime.strptime(date + ' ' + hm, '%Y-%m-%d %H:%M').replace(tzinfo=timezone.utc)
+            if int(o) != offset(zone, t):
+                wrong.append('%s, tzdata %d' % (line, offset(zone, t)))
+
+        print('%-5s %-20s %d-%d: %d transitions%s, %d random instants%s' % (
+            name, zname, first, last, len(want) - 1, '' if not bad else ' FAILED',
+            RANDOM, '' if not wrong else ' FAILED'))
+        for g, w in bad[:5]:
+            print('    tz.c %s, tzdata %s' % (g, w))
+        for w in wrong[:5]:
+            print('    ' + w)
+        failed |= bool(bad or wrong)
+
+    order = [name for name, _, _ in RULES] * 2
+    got = tz_test(binary, 'select')
+    print('select: %s%s' % (' '.join(got), '' if got == order else ' FAILED, want ' + ' '.join(order)))
+    failed |= got != order
+    sys.exit(1 if failed else 0)
+
+
+main()
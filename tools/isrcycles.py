@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+#
+# worst case clock count of an assembler function, for the display isr
+# usage: isrcycles.py build/main.asm _timer0_isr budget
+#        isrcycles.py --pass build/main.asm _function
+#
+# sums every instruction between the label and the next function, which is
+# the worst case for straight line code with forward branches only (backward
+# branches are rejected). Timing is STC-Y5 (STC15 datasheet instruction
+# table), system clocks, branches counted as taken.
+# --pass takes any compiled function: every instruction counted once, loops
+# and callees not followed, a size weighted speed figure to compare builds.
+#
+
+import re
+import sys
+
+# mnemonic + operand classes: a, b (acc/b as direct), r (Rn), i (@Ri),
+# n (#immediate), d (direct/bit), c (carry), l (label)
+CLOCKS = {
+    'push d': 3, 'pop d': 2, 'reti': 4, 'ret': 4, 'nop': 1,
+    'mov a,d': 2, 'mov a,r': 1, 'mov a,i': 2, 'mov a,n': 2,
+    'mov d,a': 2, 'mov d,r': 2, 'mov d,i': 3, 'mov d,n': 3, 'mov d,d': 3,
+    'mov r,a': 1, 'mov r,d': 3, 'mov r,n': 2, 'mov i,a': 2, 'mov i,n': 2,
+    'mov c,d': 2, 'mov d,c': 3,
+    'add a,d': 2, 'add a,n': 2, 'add a,r': 1, 'add a,i': 2,
+    'addc a,d': 2, 'addc a,n': 2, 'subb a,d': 2, 'subb a,n': 2,
+    'anl a,n': 2, 'anl a,d': 2, 'anl d,a': 3, 'anl d,n': 3,
+    'orl a,n': 2, 'orl a,d': 2, 'orl d,a': 3, 'orl d,n': 3,
+    'xrl a,n': 2, 'xrl d,a': 3, 'xrl d,n': 3,
+    'xch a,r': 2, 'xch a,d': 3, 'xch a,i': 3,
+    'inc a': 1, 'inc d': 3, 'inc r': 2, 'dec a': 1, 'dec d': 3,
+    'rl a': 1, 'rr a': 1, 'rlc a': 1, 'rrc a': 1, 'swap a': 1, 'clr a': 1, 'cpl a': 1,
+    'div ab': 6, 'mul ab': 2,
+    'setb d': 3, 'clr d': 3, 'cpl d': 3, 'setb c': 1, 'clr c': 1,
+    'jc l': 3, 'jnc l': 3, 'jz l': 4, 'jnz l': 4, 'jb d,l': 5, 'jnb d,l': 5,
+    'djnz d,l': 5, 'djnz r,l': 4, 'sjmp l': 3,
+    # compiled code
+    'mov i,d': 3, 'mov d,i': 3, 'mov p,n': 3, 'inc p': 1, 'inc i': 3, 'dec r': 2, 'dec i': 3,
+    'movc a,x': 5, 'movc a,y': 4, 'jmp x': 5,
+    'addc a,r': 1, 'addc a,i': 2, 'subb a,r': 1, 'subb a,i': 2, 'da a': 3,
+    'anl a,r': 1, 'anl a,i': 2, 'orl a,r': 1, 'orl a,i': 2,
+    'xrl a,r': 1, 'xrl a,i': 2, 'xrl a,d': 2, 'xchd a,i': 3,
+    'cpl c': 1, 'anl c,d': 2, 'orl c,d': 2, 'jbc d,l': 5,
+    'cjne a,n,l': 4, 'cjne a,d,l': 5, 'cjne r,n,l': 4, 'cjne i,n,l': 5,
+    'lcall d': 4, 'acall d': 4, 'ljmp d': 4, 'ajmp d': 3, 'ljmp l': 4, 'ajmp l': 3, 'sjmp d': 3,
+}
+
+LABEL_RE = re.compile(r'^\s*(\w+\$?):')
+# next function: its local allocation info or function header comment
+END_RE = re.compile(r'^;(Allocation info|\s+function\s)')
+
+
+def operand(op, last):
+    op = op.strip().lower()
+    if op == 'a':
+        return 'a'
+    if op in ('ab', 'c'):
+        return op
+    if op == 'dptr':
+        return 'p'
+    if op == '@a+dptr':
+        return 'x'
+    if op == '@a+pc':
+        return 'y'
+    if op.startswith('#'):
+        return 'n'
+    if op.startswith('@r'):
+        return 'i'
+    if re.match(r'^r[0-7]$', op):
+        return 'r'
+    if last and re.match(r'^\w+\$$', op):
+        return 'l'
+    return 'd'
+
+
+def main():
+    args = sys.argv[1:]
+    one_pass = args[0] == '--pass'
+    if one_pass:
+        args = args[1:]
+    path, func = args[0], args[1]
+    budget = 0 if one_pass else int(args[2])
+    lines = open(path, errors='replace').read().split('\n')
+    try:
+        start = lines.index(func + ':')
+    except ValueError:
+        sys.exit('%s not found in %s' % (func, path))
+
+    total, calls, seen = 0, 0, set()
+    for line in lines[start + 1:]:
+        if END_RE.match(line):
+            break
+        code = line.split(';', 1)[0]
+        m = LABEL_RE.match(code)
+        if m:
+            seen.add(m.group(1))
+            code = code[m.end():]
+        words = code.split(None, 1)
+        if not words or words[0].startswith('.') or '=' in code:
+            continue
+        ops = words[1].split(',') if len(words) > 1 else []
+        key = ' '.join([words[0].lower()] + ([','.join(operand(o, i == len(ops) - 1)
+                                                       for i, o in enumerate(ops))] if ops else []))
+        if key not in CLOCKS:
+            sys.exit('no timing for: %s' % line.strip())
+        if not one_pass and ops and operand(ops[-1], True) == 'l' and ops[-1].strip() in seen:
+            sys.exit('backward branch, not straight line: %s' % line.strip())
+        total += CLOCKS[key]
+        if words[0].lower() in ('lcall', 'acall'):
+            calls += 1
+        if not one_pass and words[0].lower() == 'reti':
+            break
+
+    if one_pass:
+        print('%s: %d clocks one pass, %d calls' % (func, total, calls))
+        return
+    print('%s: %d clocks worst case, budget %d' % (func, total, budget))
+    sys.exit(1 if total > budget else 0)
+
+
+main()
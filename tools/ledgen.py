@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+#
+# generate 7-segment lookup tables from glyph/wiring description
+# usage: ledgen.py tables src/glyphs.def > build/ledtable.h
+#        ledgen.py chars src/glyphs.def > build/ledchar.h
+#
+
+import sys
+
+SEGMENTS = ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'dp']
+
+
+def parse(path):
+    tables, digits, glyphs, chars = [], {}, [], {}
+    for lineno, line in enumerate(open(path), 1):
+        words = line.split('#', 1)[0].split()
+        if not words:
+            continue
+        kind, args = words[0], words[1:]
+        if kind == 'table':
+            tables.append((args[0], args[1], [int(b) for b in args[2:10]]))
+        elif kind == 'digit':
+            digits[int(args[0])] = args[1]
+        elif kind == 'char':
+            chars[int(args[0], 0)] = args[1]
+        elif kind == 'glyph':
+            segs = set()
+            s = args[1]
+            if s != '-':
+                if s.endswith('dp'):
+                    segs.add('dp')
+                    s = s[:-2]
+                segs.update(s)
+            if not segs <= set(SEGMENTS):
+                sys.exit('%s:%d: unknown segment in %s' % (path, lineno, args[1]))
+            glyphs.append((args[0], frozenset(segs), args[2] if len(args) > 2 else None))
+        else:
+            sys.exit('%s:%d: unknown keyword %s' % (path, lineno, kind))
+    return tables, digits, glyphs, chars
+
+
+def assign(glyphs):
+    # index per glyph, identical unconditional glyphs share an entry,
+    # conditional variants of one name share the name's entry
+    entries, names, by_segs = [], {}, {}
+    for name, segs, flag in glyphs:
+        if name in names:
+            entries[names[name]].append((segs, flag))
+            continue
+        if flag is None and segs in by_segs:
+            names[name] = by_segs[segs]
+            continue
+        names[name] = len(entries)
+        entries.append([(segs, flag)])
+        if flag is None:
+            by_segs[segs] = names[name]
+    return entries, names
+
+
+def pattern(segs, bits):
+    v = 0xFF
+    for i, s in enumerate(SEGMENTS):
+        if s in segs:
+            v &= ~(1 << bits[i])
+    return v
+
+
+def cond(flag):
+    if flag.startswith('!'):
+        return '!defined(%s)' % flag[1:]
+    return 'defined(%s)' % flag
+
+
+def charmap(names, chars):
+    # ascii 0x20..0x5f to glyph index, lower case is folded by the user
+    # single character glyph names map to themselves, upper case preferred
+    out = []
+    for c in range(0x20, 0x60):
+        name = chars.get(c)
+        if name is None:
+            ch = chr(c)
+            name = ch if ch in names else ch.lower()
+        out.append(names.get(name, names['BLANK']))
+    return out
+
+
+def main():
+    mode, path = sys.argv[1], sys.argv[2]
+    tables, digits, glyphs, chars = parse(path)
+    entries, names = assign(glyphs)
+    out = sys.stdout.write
+
+    if mode == 'chars':
+        out('// generated by tools/ledgen.py from %s, do not edit\n\n' % path)
+        out('#include <stdint.h>\n\n')
+        out('// ascii 0x20..0x5f to index into ledtable[]\n')
+        out('#define LEDCHAR_FIRST 0x20\n')
+        out('#define LEDCHAR_LAST  0x5f\n\n')
+        out('__code uint8_t ledchar[] = {\n')
+        cmap = charmap(names, chars)
+        for row in range(0, len(cmap), 8):
+            out('    %s, // %s\n' % (', '.join('0x%02x' % v for v in cmap[row:row + 8]),
+                                     repr(''.join(chr(0x20 + i) for i in range(row, row + 8)))))
+        out('};\n')
+        return
+
+    label = {}
+    for name, idx in names.items():
+        label.setdefault(idx, []).append(name)
+
+    out('// generated by tools/ledgen.py from %s, do not edit\n\n' % path)
+    out('#include <stdint.h>\n\n')
+    out('// index into ledtable[]\n')
+    for name, idx in names.items():
+        if not name.isdigit():
+            out('#define LED_%-6s 0x%02x\n' % (name, idx))
+    out('#define LED_COUNT  0x%02x\n\n' % len(entries))
+
+    # the stc15f204ea reads the tables from eeprom sector 0, mapped right
+    # after its 4k of code; on the stc15w408as that address is code space
+    out('#ifdef stc15f204ea\n#define LEDTABLE_AT(addr) __at (addr)\n')
+    out('#else\n#define LEDTABLE_AT(addr)\n#endif\n\n')
+    for tname, addr, bits in tables:
+        out('const uint8_t LEDTABLE_AT(%s) %s[]\n = {\n' % (addr, tname))
+        for idx, variants in enumerate(entries):
+            comment = '0x%02x - %s' % (idx, ' '.join(label[idx]))
+            if len(variants) == 1:
+                out('    0b{0:08b}, // {1}\n'.format(pattern(variants[0][0], bits), comment))
+                continue
+            for n, (segs, flag) in enumerate(variants):
+                if n == 0:
+                    out('#if %s\n' % cond(flag))
+                elif flag == '!' + variants[0][1]:
+                    out('#else\n')
+                else:
+                    out('#elif %s\n' % cond(flag))
+                out('    0b{0:08b}, // {1}\n'.format(pattern(segs, bits), comment))
+            out('#endif\n')
+        out('};\n\n')
+
+    # per digit table and decimal point, resolved at compile time by token pasting
+    dp_bits = {t: bits[SEGMENTS.index('dp')] for t, a, bits in tables}
+    for pos in sorted(digits):
+        out('#define LEDTABLE_%d  %s\n' % (pos, digits[pos]))
+        out('#define LEDDP_%d     0x%02x\n' % (pos, 0xFF & ~(1 << dp_bits[digits[pos]])))
+    out('#define LEDTABLE(pos) LEDTABLE_##pos\n')
+    out('#define LEDDP(pos)    LEDDP_##pos\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+#
+# sdcc option sweep: code size vs. static clock estimate of the hot functions
+# usage: optsweep.py [-j jobs] [--sdcc sdcc,sdcc-4.2.0] [--only regex] base-opts features rev
+#
+# builds every combination of the option groups below with every sdcc given
+# (default: sdcc and sdcc-* found in PATH) through make, each in its own
+# build/sweep/ dir, TIMER0_C_ISR added so the display isr is compiled code.
+# Per build: code bytes (main.mem), worst case stack (stackdepth.py) and
+# the one pass clock count of FUNCS (isrcycles.py --pass): every instruction
+# of the function summed once, loops and callees not followed. There is no
+# board simulator, these are static estimates to compare code paths between
+# builds, not measured cycles; the table header says so.
+# Builds on the size/clocks pareto front are marked with *.
+#
+
+import glob
+import os
+import re
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from itertools import product
+
+GROUPS = [
+    ('opt', ['', '--opt-code-speed', '--opt-code-size']),
+    ('allocs', ['', '--max-allocs-per-node 10000', '--max-allocs-per-node 50000']),
+    ('stack', ['', '--stack-auto']),
+    ('peep', ['', '--peep-return', '--no-peep']),
+]
+
+# display isr, 10ms tick, per gps byte, keyboard state machine; module asm
+# each is compiled into
+FUNCS = [('main', '_timer0_isr'), ('main', '_tick_isr'), ('nmea', '_nmea_feed'),
+         ('main', '_k_dispatch')]
+
+ROM_RE = re.compile(r'ROM/EPROM/FLASH\s+\S+\s+\S+\s+(\d+)\s+(\d+)')
+STACK_RE = re.compile(r'worst case: .* = (\d+) bytes')
+AVAIL_RE = re.compile(r'(\d+) bytes available, (-?\d+) left')
+PASS_RE = re.compile(r': (\d+) clocks one pass')
+VERSION_RE = re.compile(r'(\d+\.\d+\.\d+)')
+
+
+def compilers(names):
+    if names:
+        return names.split(',')
+    found = ['sdcc']
+    for d in os.environ.get('PATH', '').split(os.pathsep):
+        for path in sorted(glob.glob(os.path.join(d, 'sdcc-[0-9]*'))):
+            if os.access(path, os.X_OK) and os.path.basename(path) not in found:
+                found.append(os.path.basename(path))
+    return found
+
+
+def version(sdcc):
+    try:
+        r = subprocess.run([sdcc, '--version'], capture_output=True, text=True)
+    except OSError:
+        return None
+    m = VERSION_RE.search(r.stdout + r.stderr)
+    return m.group(1) if m else '?'
+
+
+def label(opts):
+    return ' '.join(o for o in opts if o) or '(default)'
+
+
+def run(tool, *args):
+    r = subprocess.run([sys.executable, os.path.join('tools', tool)] + list(args),
+                       capture_output=True, text=True)
+    return r.stdout
+
+
+def build(job):
+    sdcc, ver, opts, base, features, rev = job
+    name = re.sub(r'[^\w.]+', '_', '%s-%s' % (ver, label(opts))).strip('_')
+    out = os.path.join('build', 'sweep', name)
+    r = subprocess.run(['make', '--no-print-directory', 'SDCC=' + sdcc, 'BUILD=' + out,
+                        'SDCCOPTS=' + ' '.join([base] + [o for o in opts if o]),
+                        'SDCCREV=' + rev, 'FEATURES=' + features + ' TIMER0_C_ISR',
+                        out + '/main.ihx'], capture_output=True, text=True)
+    row = {'sdcc': ver, 'opts': label(opts), 'code': None}
+    mem = os.path.join(out, 'main.mem')
+    if r.returncode or not os.path.exists(mem):
+        row['error'] = (r.stderr.strip().split('\n') or ['build failed'])[-1]
+        return row
+    m = ROM_RE.search(open(mem, errors='replace').read())
+    row['code'] = int(m.group(1)) if m else None
+    # display isr runs at high priority (PT0), as make stack-report
+    text = run('stackdepth.py', '--high', '1', out)
+    m = STACK_RE.search(text)
+    row['stack'] = int(m.group(1)) if m else None
+    m = AVAIL_RE.search(text)
+    row['left'] = int(m.group(2)) if m else None
+    row['clocks'] = {}
+    for module, f in FUNCS:
+        m = PASS_RE.search(run('isrcycles.py', '--pass', os.path.join(out, module + '.asm'), f))
+        row['clocks'][f] = int(m.group(1)) if m else None
+    return row
+
+
+def pareto(rows):
+    # not beaten on both code and summed clocks by any other build
+    def key(r):
+        return r['code'], sum(v for v in r['clocks'].values() if v)
+    for r in rows:
+        c, t = key(r)
+        r['front'] = not any(key(o)[0] <= c and key(o)[1] <= t and key(o) != (c, t) for o in rows)
+
+
+def main():
+    args = sys.argv[1:]
+    jobs, names, only = os.cpu_count() or 1, None, None
+    while args and args[0].startswith('-'):
+        opt = args.pop(0)
+        if opt == '-j':
+            jobs = int(args.pop(0))
+        elif opt == '--sdcc':
+            names = args.pop(0)
+        elif opt == '--only':
+            only = re.compile(args.pop(0))
+        else:
+            sys.exit('unknown option %s' % opt)
+    base, features, rev = args
+
+    work = []
+    for sdcc in compilers(names):
+        ver = version(sdcc)
+        if ver is None:
+            print('%s not found, skipped' % sdcc)
+            continue
+        for opts in product(*[values for _, values in GROUPS]):
+            if only is None or only.search(label(opts)):
+                work.append((sdcc, ver, opts, base, features, rev))
+    if not work:
+        sys.exit('nothing to build')
+
+    with ThreadPoolExecutor(jobs) as pool:
+        rows = list(pool.map(build, work))
+    ok = [r for r in rows if r['code'] is not None]
+    pareto(ok)
+
+    print('clock columns: static one pass instruction sums (isrcycles.py --pass),')
+    print('loops and callees not followed; estimates to compare builds, not cycles')
+    print('%-8s %-64s %6s %5s %5s %s' % ('sdcc', 'options', 'code', 'stack', 'left',
+                                          ' '.join('%12s' % ('~' + f.lstrip('_')[:11]) for _, f in FUNCS)))
+    for r in sorted(ok, key=lambda r: r['code']):
+        print('%-8s %-64s %6d %5s %5s %s %s' % (
+            r['sdcc'], r['opts'], r['code'], r['stack'], r['left'],
+            ' '.join('%12s' % ('?' if r['clocks'][f] is None else r['clocks'][f]) for _, f in FUNCS),
+            '*' if r['front'] else ''))
+    for r in rows:
+        if r['code'] is None:
+            print('%-8s %-64s failed: %s' % (r['sdcc'], r['opts'], r['error']))
+
+
+main()
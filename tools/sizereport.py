@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+# code/ram size report from sdcc build output
+# usage: sizereport.py [--update] build tools/size-budget.txt tools/size-baseline.txt
+#
+# reads build/main.mem (totals, stack), build/main.map (per function code)
+# and build/*.rel (per module area sizes), diffs against the baseline and
+# exits non-zero when a budget is exceeded. --update rewrites the baseline.
+# A missing baseline, or build output none of the patterns below match
+# (e.g. another sdcc/aslink map format), is an error, not an empty report.
+#
+
+import glob
+import os
+import re
+import sys
+
+# module areas, as named by sdcc/aslink
+AREAS = [
+    ('code', ('CSEG', 'HOME', 'GSINIT', 'GSFINAL', 'CONST', 'CABS')),
+    ('data', ('DSEG',)),
+    ('ovl', ('OSEG',)),
+    ('idata', ('ISEG',)),
+    ('bit', ('BSEG',)),
+]
+
+AREA_RE = re.compile(r'^(\w+)\s+([0-9A-Fa-f]{4,8})\s+([0-9A-Fa-f]{4,8})\s+=\s+(\d+)\.\s+bytes\s+\(([^)]*)\)')
+SYM_RE = re.compile(r'^\s+(?:\w:)?\s*([0-9A-Fa-f]{4,8})\s+(\S+)\s+(\S+)\s*$')
+REL_AREA_RE = re.compile(r'^A\s+(\w+)\s+size\s+([0-9A-Fa-f]+)\s+flags')
+ROM_RE = re.compile(r'ROM/EPROM/FLASH\s+\S+\s+\S+\s+(\d+)\s+(\d+)')
+STACK_RE = re.compile(r'Stack starts at: 0x([0-9A-Fa-f]+).*with (\d+) bytes available')
+
+
+def modules(build):
+    # area sizes per module from the relocatable object headers
+    out = {}
+    for path in sorted(glob.glob(os.path.join(build, '*.rel'))):
+        sizes = dict.fromkeys([k for k, _ in AREAS], 0)
+        for line in open(path, errors='replace'):
+            m = REL_AREA_RE.match(line)
+            if not m:
+                continue
+            for key, names in AREAS:
+                if m.group(1) in names:
+                    sizes[key] += int(m.group(2), 16)
+        out[os.path.splitext(os.path.basename(path))[0]] = sizes
+    return out
+
+
+def functions(build):
+    # code size per global in CSEG, distance to the next symbol
+    area, end, syms = None, 0, []
+    for line in open(os.path.join(build, 'main.map'), errors='replace'):
+        m = AREA_RE.match(line)
+        if m:
+            area = m.group(1)
+            if area == 'CSEG':
+                end = int(m.group(2), 16) + int(m.group(3), 16)
+            continue
+        m = SYM_RE.match(line)
+        if m and area == 'CSEG':
+            syms.append((int(m.group(1), 16), m.group(2), m.group(3)))
+    syms.sort()
+    out = {}
+    for i, (addr, name, module) in enumerate(syms):
+        nxt = syms[i + 1][0] if i + 1 < len(syms) else end
+        if nxt > addr:
+            out[name.lstrip('_')] = (nxt - addr, module)
+    return out
+
+
+def totals(build):
+    text = open(os.path.join(build, 'main.mem'), errors='replace').read()
+    out = {}
+    m = ROM_RE.search(text)
+    if m:
+        out['code'], out['code_max'] = int(m.group(1)), int(m.group(2))
+    m = STACK_RE.search(text)
+    if m:
+        out['iram'], out['stack'] = int(m.group(1), 16), int(m.group(2))
+    return out
+
+
+def load(path):
+    # "key value" lines, # comments
+    out = {}
+    if os.path.exists(path):
+        for line in open(path):
+            words = line.split('#', 1)[0].split()
+            if len(words) == 2:
+                out[words[0]] = int(words[1])
+    return out
+
+
+def delta(new, old):
+    if old is None:
+        return '   new'
+    return '%+6d' % (new - old) if new != old else ''
+
+
+def main():
+    args = sys.argv[1:]
+    update = '--update' in args
+    args = [a for a in args if a != '--update']
+    build, budget_path, baseline_path = args
+
+    mods, funcs, tot = modules(build), functions(build), totals(build)
+    base = load(baseline_path)
+    unparsed = [what for what, ok in (
+        ('module areas in *.rel', any(sum(s.values()) for s in mods.values())),
+        ('CSEG symbols in main.map', funcs),
+        ('ROM/EPROM/FLASH line in main.mem', 'code' in tot),
+        ('stack line in main.mem', 'stack' in tot)) if not ok]
+    if unparsed:
+        sys.exit('%s: nothing parsed from %s' % (build, ', '.join(unparsed)))
+    now = {}
+
+    print('%-12s %6s %6s %6s %6s %6s' % ('module', *[k for k, _ in AREAS]))
+    for name, sizes in mods.items():
+        print('%-12s %6d %6d %6d %6d %6d' % (name, *[sizes[k] for k, _ in AREAS]))
+        for key, _ in AREAS:
+            now['%s.%s' % (name, key)] = sizes[key]
+    print()
+
+    print('%-28s %-10s %6s' % ('function', 'module', 'code'))
+    for name, (size, module) in sorted(funcs.items(), key=lambda f: -f[1][0]):
+        key = 'fn.' + name
+        now[key] = size
+        print('%-28s %-10s %6d %s' % (name, module, size, delta(size, base.get(key) if base else size)))
+    print()
+
+    for key in ('code', 'iram', 'stack'):
+        if key in tot:
+            now[key] = tot[key]
+            print('%-6s %6d %s' % (key, tot[key], delta(tot[key], base.get(key) if base else tot[key])))
+    if update:
+        with open(baseline_path, 'w') as f:
+            f.write('# generated by tools/sizereport.py --update\n')
+            for key in sorted(now):
+                f.write('%s %d\n' % (key, now[key]))
+        return
+    if not base:
+        sys.exit('no baseline %s, run make size-baseline on an sdcc build and commit it'
+                 % baseline_path)
+
+    # budgets: code/iram are upper limits, stack is the minimum left free
+    failed = False
+    for key, limit in load(budget_path).items():
+        if key not in tot:
+            continue
+        over = tot[key] < limit if key == 'stack' else tot[key] > limit
+        if over:
+            print('budget exceeded: %s %d, limit %d' % (key, tot[key], limit))
+            failed = True
+    sys.exit(1 if failed else 0)
+
+
+main()
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# worst case stack depth from sdcc assembler output
+# usage: stackdepth.py [--high vector,...] build
+#
+# builds the call graph from build/*.asm (lcall/acall/ljmp to _functions,
+# __sdcc_call_dptr to every function whose address is taken), adds return
+# addresses and pushes per function, and combines main with the interrupt
+# handlers: low priority isrs do not nest, one high priority isr (--high)
+# can preempt a low one. Result is checked against the stack space reported
+# in build/main.mem, exits non-zero when it does not fit or on recursion.
+#
+
+import glob
+import os
+import re
+import sys
+
+# unknown callees (sdcc library: mul/div helpers, ...), assumed depth
+EXTERN_DEPTH = 6
+
+FUNC_RE = re.compile(r'^;\s+function\s+(\w+)')
+LABEL_RE = re.compile(r'^(_\w+):')
+CALL_RE = re.compile(r'^\s+(?:lcall|acall)\s+(\w+)')
+JMP_RE = re.compile(r'^\s+(?:ljmp|sjmp|ajmp)\s+(_\w+)\s*$')
+ADDR_RE = re.compile(r'\b(_[A-Za-z]\w*)\b')
+BANK_RE = re.compile(r'^\s+ar0\s*=\s*0x([0-9A-Fa-f]+)')
+STACK_RE = re.compile(r'Stack starts at: 0x([0-9A-Fa-f]+).*with (\d+) bytes available')
+
+
+class Func:
+    def __init__(self, name, module):
+        self.name, self.module = name, module
+        self.calls, self.push, self.bank = set(), 0, 0
+        self.indirect = False
+
+
+def parse(build):
+    funcs, taken, vectors = {}, set(), []
+    for path in sorted(glob.glob(os.path.join(build, '*.asm'))):
+        module = os.path.splitext(os.path.basename(path))[0]
+        cur, depth, in_vect = None, 0, False
+        for line in open(path, errors='replace'):
+            code = line.split(';', 1)[0]
+            op = code.split()
+            if line.startswith('__interrupt_vect:'):
+                in_vect = True
+                continue
+            if in_vect:
+                # 8 byte slots: ljmp handler or reti, padded with .ds
+                if op and op[0] == 'ljmp':
+                    vectors.append(op[1])
+                elif op and op[0] == 'reti':
+                    vectors.append(None)
+                elif not op or op[0] != '.ds':
+                    in_vect = False
+                continue
+            m = FUNC_RE.match(line)
+            if m:
+                cur = Func('_' + m.group(1), module)
+                funcs[cur.name] = cur
+                depth = 0
+                continue
+            if not op or LABEL_RE.match(code):
+                continue
+            if op[0].startswith('.') and op[0] not in ('.db', '.byte', '.dw', '.word'):
+                continue
+            m = CALL_RE.match(code) or JMP_RE.match(code)
+            if m:
+                if cur is None:
+                    continue
+                if m.group(1) == '__sdcc_call_dptr':
+                    cur.indirect = True
+                else:
+                    cur.calls.add(m.group(1))
+                continue
+            # address taken: tables (.byte/.dw) or mov dptr,#_f
+            taken.update(ADDR_RE.findall(code))
+            if cur is None:
+                continue
+            m = BANK_RE.match(line)
+            if m:
+                cur.bank = int(m.group(1), 16) // 8
+            elif op[0] == 'push':
+                depth += 1
+                cur.push = max(cur.push, depth)
+            elif op[0] == 'pop':
+                depth = max(depth - 1, 0)
+            elif op[0] in ('ret', 'reti'):
+                depth = 0
+    return funcs, taken, vectors
+
+
+def depth(funcs, taken, name, path, memo):
+    # bytes below the caller's sp used by a call to name, return address included
+    if name in memo:
+        return memo[name]
+    if name in path:
+        sys.exit('recursion: %s' % ' -> '.join(path + [name]))
+    f = funcs.get(name)
+    if f is None:
+        memo[name] = (EXTERN_DEPTH, [name + ' (extern)'])
+        return memo[name]
+    callees = set(f.calls)
+    if f.indirect:
+        callees |= {t for t in taken if t in funcs}
+    best, chain = 0, []
+    for c in sorted(callees):
+        if c == name:
+            continue
+        d, ch = depth(funcs, taken, c, path + [name], memo)
+        if d > best:
+            best, chain = d, ch
+    memo[name] = (2 + f.push + best, [name] + chain)
+    return memo[name]
+
+
+def main():
+    args = sys.argv[1:]
+    high = set()
+    if args and args[0] == '--high':
+        high = set(int(v) for v in args[1].split(','))
+        args = args[2:]
+    build = args[0]
+
+    funcs, taken, vectors = parse(build)
+    memo = {}
+    if '_main' not in funcs:
+        sys.exit('no main in %s/*.asm' % build)
+    # main is entered with a jump, no return address on the stack
+    main_depth, main_chain = depth(funcs, taken, '_main', [], memo)
+    main_depth -= 2
+
+    print('%-22s %5s %4s  %s' % ('entry', 'stack', 'bank', 'deepest path'))
+    print('%-22s %5d %4d  %s' % ('main', main_depth, funcs['_main'].bank, ' > '.join(main_chain)))
+
+    isrs, banks = [], {}
+    for vect, name in enumerate(vectors):
+        if vect == 0 or name not in funcs:
+            continue
+        d, chain = depth(funcs, taken, name, [], memo)
+        vect -= 1
+        isrs.append((vect in high, d, name))
+        banks.setdefault(funcs[name].bank, set()).add(vect in high)
+        print('%-22s %5d %4d  %s' % ('isr %d %s' % (vect, name), d,
+                                      funcs[name].bank, ' > '.join(chain)))
+
+    # low isrs do not preempt each other, a high one preempts any low one
+    low = max([d for h, d, _ in isrs if not h] or [0])
+    hi = max([d for h, d, _ in isrs if h] or [0])
+    worst = main_depth + low + hi
+    print()
+    print('worst case: main %d + low isr %d + high isr %d = %d bytes' % (main_depth, low, hi, worst))
+
+    failed = False
+    for bank, prio in sorted(banks.items()):
+        if bank and len(prio) > 1:
+            print('register bank %d shared by isrs of both priorities' % bank)
+            failed = True
+    used = sorted(set([0] + [f.bank for f in funcs.values()]))
+    print('register banks in use: %s (0x00-0x%02x)' % (', '.join(map(str, used)), used[-1] * 8 + 7))
+
+    mem = os.path.join(build, 'main.mem')
+    if os.path.exists(mem):
+        m = STACK_RE.search(open(mem, errors='replace').read())
+        if m:
+            avail = int(m.group(2))
+            print('stack at 0x%s, %d bytes available, %d left' % (m.group(1), avail, avail - worst))
+            if worst > avail:
+                print('stack overflow')
+                failed = True
+    sys.exit(1 if failed else 0)
+
+
+main()